@@ -103,6 +103,47 @@ declare namespace Cordova {
             then(doneCallBack: (context: IAuthenticationResult) => void, failCallBack?: (message: string) => void);
         }
 
+        interface ITokenRefreshRegistration {
+            resource: string,
+            clientId: string,
+            userId: string,
+            expiresOn: Date,
+            nextRefreshOn: Date,
+            lastRefreshOn: Date,
+            lastOutcome: string,
+            lastError: string,
+            successCount: number,
+            failureCount: number
+        }
+
+        interface IPromiseTokenRefreshSchedule {
+            then(doneCallBack: (schedule: ITokenRefreshRegistration[]) => void, failCallBack?: (message: string) => void);
+        }
+
+        interface ILatencyHistogram {
+            count: number,
+            p50: number,
+            p90: number,
+            p99: number,
+            max: number
+        }
+
+        interface IRequestQueueMetrics {
+            depth: number,
+            averageWaitMs: number,
+            maxWaitMs: number
+        }
+
+        interface IMetricsSnapshot {
+            counters: { [name: string]: number },
+            requestQueue?: IRequestQueueMetrics,
+            [operation: string]: any
+        }
+
+        interface IPromiseMetricsSnapshot {
+            then(doneCallBack: (snapshot: IMetricsSnapshot) => void, failCallBack?: (message: string) => void);
+        }
+
         interface IAuthenticationContext {
             authority: string,
             validateAuthority: boolean,
@@ -138,6 +179,37 @@ declare namespace Cordova {
              */
             acquireTokenSilentAsync(resourceUrl: string, clientId: string, userId: string): IPromiseAuthenticationResult;
 
+            /**
+             * Registers a token to be refreshed in the background ahead of its expiry, so that later
+             * acquireTokenSilentAsync calls for the same resource, client and user are served from cache.
+             *
+             * @param   {String}  resourceUrl Resource identifier
+             * @param   {String}  clientId    Client (application) identifier
+             * @param   {String}  userId      User identifier (optional)
+             *
+             * @returns {Promise} Promise either fulfilled when the token is registered or rejected with error
+             */
+            registerTokenRefresh(resourceUrl: string, clientId: string, userId?: string): IPromise;
+
+            /**
+             * Stops refreshing a token previously registered with registerTokenRefresh.
+             *
+             * @param   {String}  resourceUrl Resource identifier
+             * @param   {String}  clientId    Client (application) identifier
+             * @param   {String}  userId      User identifier (optional)
+             *
+             * @returns {Promise} Promise either fulfilled when the token is unregistered or rejected with error
+             */
+            unregisterTokenRefresh(resourceUrl: string, clientId: string, userId?: string): IPromise;
+
+            /**
+             * Gets the background refresh schedule and the outcome of the last refresh for every token
+             * registered with registerTokenRefresh.
+             *
+             * @returns {Promise} Promise either fulfilled with array of schedule entries or rejected with error
+             */
+            getTokenRefreshScheduleAsync(): IPromiseTokenRefreshSchedule;
+
         }
 
         interface IPromiseAuthenticationContext {
@@ -175,6 +247,15 @@ declare namespace Cordova {
             */
             static createAsync(authority: string, validateAuthority?: boolean): IPromiseAuthenticationContext;
 
+            /**
+            * Gets latency histograms (ILatencyHistogram) collected by the native layer since the app started,
+            * keyed by operation, plus a 'counters' entry. The set of operations may differ between platforms.
+            * On Android the snapshot also has a 'requestQueue' entry with the token request queue depth and wait times.
+            *
+            * @returns {Promise} Promise either fulfilled with metrics snapshot object or rejected with error
+            */
+            static getMetricsSnapshot(): IPromiseMetricsSnapshot;
+
             /**
             * Acquires token using interactive flow if needed. It checks the cache to return existing result
             * if not expired. It tries to use refresh token if available. If it fails to get token with
@@ -205,6 +286,37 @@ declare namespace Cordova {
              */
             acquireTokenSilentAsync(resourceUrl: string, clientId: string, userId: string): IPromiseAuthenticationResult;
 
+            /**
+             * Registers a token to be refreshed in the background ahead of its expiry, so that later
+             * acquireTokenSilentAsync calls for the same resource, client and user are served from cache.
+             *
+             * @param   {String}  resourceUrl Resource identifier
+             * @param   {String}  clientId    Client (application) identifier
+             * @param   {String}  userId      User identifier (optional)
+             *
+             * @returns {Promise} Promise either fulfilled when the token is registered or rejected with error
+             */
+            registerTokenRefresh(resourceUrl: string, clientId: string, userId?: string): IPromise;
+
+            /**
+             * Stops refreshing a token previously registered with registerTokenRefresh.
+             *
+             * @param   {String}  resourceUrl Resource identifier
+             * @param   {String}  clientId    Client (application) identifier
+             * @param   {String}  userId      User identifier (optional)
+             *
+             * @returns {Promise} Promise either fulfilled when the token is unregistered or rejected with error
+             */
+            unregisterTokenRefresh(resourceUrl: string, clientId: string, userId?: string): IPromise;
+
+            /**
+             * Gets the background refresh schedule and the outcome of the last refresh for every token
+             * registered with registerTokenRefresh.
+             *
+             * @returns {Promise} Promise either fulfilled with array of schedule entries or rejected with error
+             */
+            getTokenRefreshScheduleAsync(): IPromiseTokenRefreshSchedule;
+
         }
     }
 }
@@ -0,0 +1,128 @@
+/*******************************************************************************
+ * Copyright (c) Microsoft Open Technologies, Inc.
+ * All Rights Reserved
+ * Licensed under the Apache License, Version 2.0.
+ * See License.txt in the project root for license information.
+ ******************************************************************************/
+
+package com.cordova.plugin.oidc;
+
+import org.apache.cordova.CallbackContext;
+import org.apache.cordova.PluginResult;
+import org.json.JSONArray;
+import org.json.JSONObject;
+
+import java.util.concurrent.Executors;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Logger that forwards OIDC log items to Cordova JS code in batches, so that verbose logging
+ * doesn't cost one bridge message per log line.
+ */
+class BatchedLogCallback implements Logger.ILogger {
+
+    /**
+     * Number of log items that triggers an immediate flush
+     */
+    private static final int MAX_BATCH_SIZE = 50;
+
+    /**
+     * Maximum time a log item waits before it's sent to JS
+     */
+    private static final long FLUSH_INTERVAL_MS = 250;
+
+    /**
+     * Cordova callback context which is used to send log items back to JS
+     */
+    private final CallbackContext callbackContext;
+
+    private final ScheduledExecutorService flushExecutor = Executors.newSingleThreadScheduledExecutor();
+
+    private JSONArray pendingItems = new JSONArray();
+
+    private boolean flushScheduled = false;
+
+    private boolean isShutdown = false;
+
+    /**
+     * Default constructor
+     * @param callbackContext Cordova callback context which is used to send log items back to JS
+     */
+    BatchedLogCallback(CallbackContext callbackContext) {
+        this.callbackContext = callbackContext;
+    }
+
+    @Override
+    public void Log(String tag, String message, String additionalMessage, Logger.LogLevel level, OIDCError errorCode) {
+
+        JSONObject logItem = new JSONObject();
+        try {
+            logItem.put("tag", tag);
+            logItem.put("additionalMessage", additionalMessage);
+            logItem.put("message", message);
+            logItem.put("level", level.ordinal());
+            logItem.put("errorCode", errorCode.ordinal());
+        }
+
+        catch(Exception ex) {
+            ex.printStackTrace();
+        }
+
+        synchronized (this) {
+            if (isShutdown) {
+                return;
+            }
+
+            pendingItems.put(logItem);
+
+            if (pendingItems.length() >= MAX_BATCH_SIZE) {
+                flushExecutor.execute(new Runnable() {
+                    @Override
+                    public void run() {
+                        flush();
+                    }
+                });
+            } else if (!flushScheduled) {
+                flushScheduled = true;
+                flushExecutor.schedule(new Runnable() {
+                    @Override
+                    public void run() {
+                        flush();
+                    }
+                }, FLUSH_INTERVAL_MS, TimeUnit.MILLISECONDS);
+            }
+        }
+    }
+
+    /**
+     * Sends all pending log items to JS as a single array
+     */
+    void flush() {
+        final JSONArray items;
+        synchronized (this) {
+            flushScheduled = false;
+            if (pendingItems.length() == 0) {
+                return;
+            }
+
+            items = pendingItems;
+            pendingItems = new JSONArray();
+        }
+
+        PluginResult logResult = new PluginResult(PluginResult.Status.OK, items);
+        logResult.setKeepCallback(true);
+        callbackContext.sendPluginResult(logResult);
+    }
+
+    /**
+     * Flushes pending log items and stops the flush timer
+     */
+    void shutdown() {
+        synchronized (this) {
+            isShutdown = true;
+        }
+        flushExecutor.shutdown();
+        flush();
+    }
+}
@@ -28,6 +28,7 @@ import java.security.spec.InvalidKeySpecException;
 import java.util.Hashtable;
 import java.util.Iterator;
 import java.util.List;
+import java.util.Map;
 
 import javax.crypto.NoSuchPaddingException;
 import javax.crypto.SecretKey;
@@ -44,9 +45,12 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
     private static final String SECRET_KEY =  "com.corodva.oidc.CordovaOIDC";
 
     private final Hashtable<String, AuthenticationContext> contexts = new Hashtable<String, AuthenticationContext>();
+    private final Hashtable<String, TokenRefreshScheduler> refreshSchedulers = new Hashtable<String, TokenRefreshScheduler>();
     private AuthenticationContext currentContext;
-    private CallbackContext callbackContext;
-    private CallbackContext loggerCallbackContext;
+    // Permission results carry no reference to the call that triggered them, so they are
+    // reported to the most recent call. Every other action replies on its own context.
+    private CallbackContext permissionCallbackContext;
+    private BatchedLogCallback logger;
 
     public CordovaOIDCPlugin() {
 
@@ -66,7 +70,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
     public boolean execute(String action, JSONArray args, final CallbackContext callbackContext) throws JSONException {
 
         this.cordova.setActivityResultCallback(this);
-        this.callbackContext = callbackContext;
+        this.permissionCallbackContext = callbackContext;
 
         if (action.equals("createAsync")) {
 
@@ -74,7 +78,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
             String authority = args.getString(0);
             // AuthenticationContext constructor validates authority by default
             boolean validateAuthority = args.optBoolean(1, true);
-            return createAsync(authority);
+            return createAsync(callbackContext, authority);
 
         } else if (action.equals("acquireTokenAsync")) {
 
@@ -90,6 +94,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
                 @Override
                 public void run() {
                     acquireTokenAsync(
+                            callbackContext,
                             authority,
                             resourceUrl,
                             clientId,
@@ -115,6 +120,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
                 @Override
                 public void run() {
                     acquireTokenSilentAsync(
+                            callbackContext,
                             authority,
                             resourceUrl, clientId, userId);
                 }
@@ -126,13 +132,13 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
 
             String authority = args.getString(0);
             boolean validateAuthority = args.optBoolean(1, true);
-            return clearTokenCache(authority);
+            return clearTokenCache(callbackContext, authority);
 
         } else if (action.equals("tokenCacheReadItems")){
 
             String authority = args.getString(0);
             boolean validateAuthority = args.optBoolean(1, true);
-            return readTokenCacheItems(authority);
+            return readTokenCacheItems(callbackContext, authority);
 
         } else if (action.equals("tokenCacheDeleteItem")){
 
@@ -145,23 +151,49 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
             String userId = args.getString(5);
             boolean isMultipleResourceRefreshToken = args.getBoolean(6);
 
-            return deleteTokenCacheItem(authority, itemAuthority, resource, clientId, userId, isMultipleResourceRefreshToken);
+            return deleteTokenCacheItem(callbackContext, authority, itemAuthority, resource, clientId, userId, isMultipleResourceRefreshToken);
+        } else if (action.equals("registerTokenRefresh")) {
+
+            String authority = args.getString(0);
+            boolean validateAuthority = args.optBoolean(1, true);
+            String resourceUrl = args.getString(2);
+            String clientId = args.getString(3);
+            String userId = args.getString(4).equals("null") ? null : args.getString(4);
+            return registerTokenRefresh(callbackContext, authority, resourceUrl, clientId, userId);
+
+        } else if (action.equals("unregisterTokenRefresh")) {
+
+            String authority = args.getString(0);
+            boolean validateAuthority = args.optBoolean(1, true);
+            String resourceUrl = args.getString(2);
+            String clientId = args.getString(3);
+            String userId = args.getString(4).equals("null") ? null : args.getString(4);
+            return unregisterTokenRefresh(callbackContext, authority, resourceUrl, clientId, userId);
+
+        } else if (action.equals("getTokenRefreshSchedule")) {
+
+            String authority = args.getString(0);
+            boolean validateAuthority = args.optBoolean(1, true);
+            return getTokenRefreshSchedule(callbackContext, authority);
+
+        } else if (action.equals("getMetricsSnapshot")) {
+            return getMetricsSnapshot(callbackContext);
+
         } else if (action.equals("setUseBroker")) {
 
             boolean useBroker = args.getBoolean(0);
-            return setUseBroker(useBroker);
+            return setUseBroker(callbackContext, useBroker);
         } else if (action.equals("setLogger")) {
-            this.loggerCallbackContext = callbackContext;
-            return setLogger();
+            return setLogger(callbackContext);
         } else if (action.equals("setLogLevel")) {
             Integer logLevel = args.getInt(0);
-            return setLogLevel(logLevel);
+            return setLogLevel(callbackContext, logLevel);
         }
 
         return false;
     }
 
-    private boolean createAsync(String authority) {
+    private boolean createAsync(final CallbackContext callbackContext, String authority) {
 
         try {
             getOrCreateContext(authority);
@@ -174,7 +206,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         return true;
     }
 
-    private void acquireTokenAsync(String authority, String resourceUrl, String clientId, String redirectUrl, String userId, String extraQueryParams) {
+    private void acquireTokenAsync(final CallbackContext callbackContext, String authority, String resourceUrl, String clientId, String redirectUrl, String userId, String extraQueryParams) {
 
         final AuthenticationContext authContext;
         try{
@@ -207,7 +239,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
                 new DefaultAuthenticationCallback(callbackContext));
     }
 
-    private void acquireTokenSilentAsync(String authority, String resourceUrl, String clientId, String userId) {
+    private void acquireTokenSilentAsync(final CallbackContext callbackContext, String authority, String resourceUrl, String clientId, String userId) {
 
         final AuthenticationContext authContext;
         try{
@@ -237,7 +269,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         authContext.acquireTokenSilentAsync(resourceUrl, clientId, userId, new DefaultAuthenticationCallback(callbackContext));
     }
 
-    private boolean readTokenCacheItems(String authority) throws JSONException {
+    private boolean readTokenCacheItems(final CallbackContext callbackContext, String authority) throws JSONException {
 
         final AuthenticationContext authContext;
         try{
@@ -264,7 +296,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         return true;
     }
 
-    private boolean deleteTokenCacheItem(String authority, String itemAuthority,  String resource,
+    private boolean deleteTokenCacheItem(final CallbackContext callbackContext, String authority, String itemAuthority,  String resource,
                                          String clientId, String userId, boolean isMultipleResourceRefreshToken) {
 
         final AuthenticationContext authContext;
@@ -282,7 +314,7 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         return true;
     }
 
-    private boolean clearTokenCache(String authority) {
+    private boolean clearTokenCache(final CallbackContext callbackContext, String authority) {
         final AuthenticationContext authContext;
         try{
             authContext = getOrCreateContext(authority);
@@ -296,7 +328,46 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         return true;
     }
 
-    private boolean setUseBroker(boolean useBroker) {
+    private boolean registerTokenRefresh(final CallbackContext callbackContext, String authority, String resourceUrl,
+                                         String clientId, String userId) {
+        final TokenRefreshScheduler scheduler;
+        try {
+            scheduler = getOrCreateRefreshScheduler(authority);
+        } catch (Exception e) {
+            callbackContext.sendPluginResult(new PluginResult(PluginResult.Status.ERROR, e.getMessage()));
+            return true;
+        }
+
+        scheduler.register(resourceUrl, clientId, userId);
+        callbackContext.success();
+        return true;
+    }
+
+    private boolean unregisterTokenRefresh(final CallbackContext callbackContext, String authority, String resourceUrl,
+                                           String clientId, String userId) {
+        TokenRefreshScheduler scheduler = refreshSchedulers.get(authority);
+        if (scheduler != null) {
+            scheduler.unregister(resourceUrl, clientId, userId);
+        }
+
+        callbackContext.success();
+        return true;
+    }
+
+    private boolean getTokenRefreshSchedule(final CallbackContext callbackContext, String authority) throws JSONException {
+        JSONArray result = new JSONArray();
+        TokenRefreshScheduler scheduler = refreshSchedulers.get(authority);
+        if (scheduler != null) {
+            for (TokenRefreshScheduler.Registration registration : scheduler.getSchedule()) {
+                result.put(refreshRegistrationToJSON(registration));
+            }
+        }
+
+        callbackContext.sendPluginResult(new PluginResult(PluginResult.Status.OK, result));
+        return true;
+    }
+
+    private boolean setUseBroker(final CallbackContext callbackContext, boolean useBroker) {
 
         try {
             AuthenticationSettings.INSTANCE.setUseBroker(useBroker);
@@ -310,7 +381,34 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         return true;
     }
 
-    private boolean setLogLevel(Integer logLevel) {
+    private boolean getMetricsSnapshot(final CallbackContext callbackContext) {
+        JSONObject snapshot = new JSONObject();
+        try {
+            for (Map.Entry<String, LatencyHistogram> entry : Telemetry.getInstance().getLatencyHistograms().entrySet()) {
+                snapshot.put(entry.getKey(), latencyHistogramToJSON(entry.getValue()));
+            }
+
+            JSONObject counters = new JSONObject();
+            for (Map.Entry<String, Long> entry : Telemetry.getInstance().getCounters().entrySet()) {
+                counters.put(entry.getKey(), entry.getValue());
+            }
+            snapshot.put("counters", counters);
+
+            JSONObject requestQueue = new JSONObject();
+            requestQueue.put("depth", AcquireTokenRequest.getQueueDepth());
+            requestQueue.put("averageWaitMs", AcquireTokenRequest.getAverageQueueWaitTimeMs());
+            requestQueue.put("maxWaitMs", AcquireTokenRequest.getMaxQueueWaitTimeMs());
+            snapshot.put("requestQueue", requestQueue);
+        } catch (JSONException e) {
+            callbackContext.sendPluginResult(new PluginResult(PluginResult.Status.JSON_EXCEPTION, e.getMessage()));
+            return true;
+        }
+
+        callbackContext.sendPluginResult(new PluginResult(PluginResult.Status.OK, snapshot));
+        return true;
+    }
+
+    private boolean setLogLevel(final CallbackContext callbackContext, Integer logLevel) {
         try {
             Logger.LogLevel level = Logger.LogLevel.values()[logLevel];
             Logger.getInstance().setLogLevel(level);
@@ -324,33 +422,33 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         return true;
     }
 
-    private boolean setLogger() {
-        Logger.getInstance().setExternalLogger(new Logger.ILogger() {
-            @Override
-            public void Log(String tag, String message, String additionalMessage, Logger.LogLevel level, OIDCError errorCode) {
-
-                JSONObject logItem = new JSONObject();
-                try {
-                    logItem.put("tag", tag);
-                    logItem.put("additionalMessage", additionalMessage);
-                    logItem.put("message", message);
-                    logItem.put("level", level.ordinal());
-                    logItem.put("errorCode", errorCode.ordinal());
-                }
+    private boolean setLogger(final CallbackContext callbackContext) {
+        BatchedLogCallback logger = new BatchedLogCallback(callbackContext);
+        Logger.getInstance().setExternalLogger(logger);
 
-                catch(Exception ex) {
-                    ex.printStackTrace();
-                }
-
-                PluginResult logResult = new PluginResult(PluginResult.Status.OK, logItem);
-                logResult.setKeepCallback(true);
-                loggerCallbackContext.sendPluginResult(logResult);
+        synchronized (this) {
+            if (this.logger != null) {
+                this.logger.shutdown();
             }
-        });
+            this.logger = logger;
+        }
 
         return true;
     }
 
+    @Override
+    public void onDestroy() {
+        for (TokenRefreshScheduler scheduler : refreshSchedulers.values()) {
+            scheduler.unregisterAll();
+        }
+        synchronized (this) {
+            if (logger != null) {
+                logger.shutdown();
+            }
+        }
+        super.onDestroy();
+    }
+
     @Override
     public void onActivityResult(int requestCode, int resultCode, Intent data) {
         super.onActivityResult(requestCode, resultCode, data);
@@ -366,14 +464,15 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         {
             if(r == PackageManager.PERMISSION_DENIED)
             {
-                this.callbackContext.sendPluginResult(new PluginResult(PluginResult.Status.ERROR, PERMISSION_DENIED_ERROR));
+                permissionCallbackContext.sendPluginResult(new PluginResult(PluginResult.Status.ERROR, PERMISSION_DENIED_ERROR));
                 return;
             }
         }
-        callbackContext.success();
+        permissionCallbackContext.success();
     }
 
-    private AuthenticationContext getOrCreateContext (String authority) throws NoSuchPaddingException, NoSuchAlgorithmException {
+    // Synchronized so that concurrent calls for the same authority share a single context
+    private synchronized AuthenticationContext getOrCreateContext (String authority) throws NoSuchPaddingException, NoSuchAlgorithmException {
 
         AuthenticationContext result;
         if (!contexts.containsKey(authority)) {
@@ -387,6 +486,17 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
         return result;
     }
 
+    private synchronized TokenRefreshScheduler getOrCreateRefreshScheduler(String authority) throws NoSuchPaddingException, NoSuchAlgorithmException {
+
+        TokenRefreshScheduler result = refreshSchedulers.get(authority);
+        if (result == null) {
+            result = new TokenRefreshScheduler(this.cordova.getActivity().getApplicationContext(), getOrCreateContext(authority));
+            refreshSchedulers.put(authority, result);
+        }
+
+        return result;
+    }
+
     private SecretKey createSecretKey(String key) throws NoSuchAlgorithmException, UnsupportedEncodingException, InvalidKeySpecException {
         SecretKeyFactory keyFactory = SecretKeyFactory.getInstance("PBEWithSHA256And256BitAES-CBC-BC");
         SecretKey tempkey = keyFactory.generateSecret(new PBEKeySpec(key.toCharArray(), "abcdedfdfd".getBytes("UTF-8"), 100, 256));
@@ -416,6 +526,35 @@ public class CordovaOIDCPlugin extends CordovaPlugin {
 		return result;
 	}
 
+	static JSONObject refreshRegistrationToJSON(TokenRefreshScheduler.Registration registration) throws JSONException {
+		JSONObject result = new JSONObject();
+
+		result.put("resource", registration.getResource());
+		result.put("clientId", registration.getClientId());
+		result.put("userId", registration.getUserId());
+		result.put("expiresOn", registration.getExpiresOn());
+		result.put("nextRefreshOn", registration.getNextRefreshAt());
+		result.put("lastRefreshOn", registration.getLastRefreshAt());
+		result.put("lastOutcome", registration.getLastOutcome());
+		result.put("lastError", registration.getLastError());
+		result.put("successCount", registration.getSuccessCount());
+		result.put("failureCount", registration.getFailureCount());
+
+		return result;
+	}
+
+	static JSONObject latencyHistogramToJSON(LatencyHistogram histogram) throws JSONException {
+		JSONObject result = new JSONObject();
+
+		result.put("count", histogram.getCount());
+		result.put("p50", histogram.getPercentileMillis(50));
+		result.put("p90", histogram.getPercentileMillis(90));
+		result.put("p99", histogram.getPercentileMillis(99));
+		result.put("max", histogram.getMaxMillis());
+
+		return result;
+	}
+
 	static JSONObject userInfoToJSON(UserInfo info) throws JSONException {
 
 		JSONObject userInfo = new JSONObject();
@@ -24,19 +24,36 @@
 package com.cordova.plugin.oidc;
 
 import android.content.Context;
-import android.util.Pair;
 
 import java.io.UnsupportedEncodingException;
 import java.net.URL;
 import java.security.NoSuchAlgorithmException;
-import java.util.List;
-import java.util.Map;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
 
 /**
  * This class tracks flows for certain API calls. Most notably in those all acquireToken* calls.
  * All other Events will be called within the timeline of APIEvent.
  */
 final class APIEvent extends DefaultEvent {
+    private static final Set<String> AGGREGATED_PROPERTIES = new HashSet<>(Arrays.asList(
+            EventStrings.AUTHORITY_TYPE,
+            EventStrings.API_DEPRECATED,
+            EventStrings.AUTHORITY_VALIDATION,
+            EventStrings.EXTENDED_EXPIRES_ON_SETTING,
+            EventStrings.PROMPT_BEHAVIOR,
+            EventStrings.WAS_SUCCESSFUL,
+            EventStrings.IDP_NAME,
+            EventStrings.TENANT_ID,
+            EventStrings.USER_ID,
+            EventStrings.LOGIN_HINT,
+            EventStrings.RESPONSE_TIME,
+            EventStrings.CORRELATION_ID,
+            EventStrings.REQUEST_ID,
+            EventStrings.API_ID,
+            EventStrings.API_ERROR_CODE
+    ));
 
     private static final String TAG = DefaultEvent.class.getSimpleName();
     private final String mEventName;
@@ -136,6 +153,11 @@ final class APIEvent extends DefaultEvent {
         }
     }
 
+    void setQueueMetrics(final int queueDepth, final long queueWaitTimeMs) {
+        setProperty(EventStrings.QUEUE_DEPTH, String.valueOf(queueDepth));
+        setProperty(EventStrings.QUEUE_WAIT_TIME, String.valueOf(queueWaitTimeMs));
+    }
+
     void setLoginHint(final String loginHint) {
         try {
             setProperty(EventStrings.LOGIN_HINT,  StringExtensions.createHash(loginHint));
@@ -146,28 +168,11 @@ final class APIEvent extends DefaultEvent {
 
     /**
      * Each event chooses which of its members get picked on aggregation.
-     * @param dispatchMap the Map that is filled with the aggregated event properties
+     * @param aggregatedEvent the aggregated event properties of the request
      */
     @Override
-    public void processEvent(final Map<String, String> dispatchMap) {
-        super.processEvent(dispatchMap);
-        final List<Pair<String, String>> eventList = getEventList();
-
-        for (Pair<String, String> eventPair : eventList) {
-            final String name = eventPair.first;
-
-            // API Event specific parameters, push all except the time values
-            if (name.equals(EventStrings.AUTHORITY_TYPE) || name.equals(EventStrings.API_DEPRECATED)
-                    || name.equals(EventStrings.AUTHORITY_VALIDATION)
-                    || name.equals(EventStrings.EXTENDED_EXPIRES_ON_SETTING)
-                    || name.equals(EventStrings.PROMPT_BEHAVIOR) || name.equals(EventStrings.WAS_SUCCESSFUL)
-                    || name.equals(EventStrings.IDP_NAME) || name.equals(EventStrings.TENANT_ID)
-                    || name.equals(EventStrings.USER_ID) || name.equals(EventStrings.LOGIN_HINT)
-                    || name.equals(EventStrings.RESPONSE_TIME) || name.equals(EventStrings.CORRELATION_ID)
-                    || name.equals(EventStrings.REQUEST_ID) || name.equals(EventStrings.API_ID)
-                    || name.equals(EventStrings.API_ERROR_CODE)) {
-                dispatchMap.put(name, eventPair.second);
-            }
-        }
+    public void processEvent(final AggregatedEvent aggregatedEvent) {
+        // API Event specific parameters, push all except the time values
+        aggregatedEvent.collect(getEventList(), AGGREGATED_PROPERTIES);
     }
 }
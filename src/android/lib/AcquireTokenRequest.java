@@ -29,6 +29,7 @@ import android.content.ContextWrapper;
 import android.content.Intent;
 import android.os.Bundle;
 import android.os.Handler;
+import android.os.SystemClock;
 import androidx.annotation.Nullable;
 
 import java.io.Serializable;
@@ -36,9 +37,8 @@ import java.io.UnsupportedEncodingException;
 import java.net.URL;
 import java.net.URLEncoder;
 import java.util.Date;
+import java.util.Locale;
 import java.util.UUID;
-import java.util.concurrent.ExecutorService;
-import java.util.concurrent.Executors;
 
 /**
  * Internal class for handling acquireToken logic, including the silent flow and interactive flow.
@@ -48,9 +48,16 @@ class AcquireTokenRequest {
     private static final String TAG = AcquireTokenRequest.class.getSimpleName();
 
     /**
-     * Singled threaded Executor for async work.
+     * Upper bound on concurrent token requests across all {@link AuthenticationContext}s.
      */
-    private static final ExecutorService THREAD_EXECUTOR = Executors.newSingleThreadExecutor();
+    private static final int MAX_CONCURRENT_REQUESTS = 4;
+
+    /**
+     * Executor for async work. Requests for the same cache entry run in order, one at a time,
+     * requests for different entries run concurrently.
+     */
+    private static final KeyedSerialExecutor THREAD_EXECUTOR =
+            new KeyedSerialExecutor("AcquireTokenRequest", MAX_CONCURRENT_REQUESTS);
 
     private final Context mContext;
     private final AuthenticationContext mAuthContext;
@@ -70,6 +77,27 @@ class AcquireTokenRequest {
      */
     private APIEvent mAPIEvent;
 
+    /**
+     * @return Number of token requests that are waiting or running.
+     */
+    static int getQueueDepth() {
+        return THREAD_EXECUTOR.getQueueDepth();
+    }
+
+    /**
+     * @return Average time in milliseconds token requests waited before they started running.
+     */
+    static long getAverageQueueWaitTimeMs() {
+        return THREAD_EXECUTOR.getAverageWaitTimeMs();
+    }
+
+    /**
+     * @return Longest time in milliseconds a token request waited before it started running.
+     */
+    static long getMaxQueueWaitTimeMs() {
+        return THREAD_EXECUTOR.getMaxWaitTimeMs();
+    }
+
     /**
      * Constructor for {@link AcquireTokenRequest}.
      */
@@ -97,11 +125,14 @@ class AcquireTokenRequest {
         // user. All UI
         // related actions will be performed using Handler.
         Logger.setCorrelationId(authRequest.getCorrelationId());
-        Logger.v(TAG, "Sending async task from thread:" + android.os.Process.myTid());
-        THREAD_EXECUTOR.execute(new Runnable() {
+        Logger.vFormat(TAG, "Sending async task from thread:%d", android.os.Process.myTid());
+        final long queuedAt = SystemClock.elapsedRealtime();
+        final int queueDepth = THREAD_EXECUTOR.getQueueDepth();
+        THREAD_EXECUTOR.execute(getSerializationKey(authRequest), new Runnable() {
             @Override
             public void run() {
-                Logger.v(TAG, "Running task in thread:" + android.os.Process.myTid());
+                Logger.vFormat(TAG, "Running task in thread:%d", android.os.Process.myTid());
+                mAPIEvent.setQueueMetrics(queueDepth, SystemClock.elapsedRealtime() - queuedAt);
                 try {
                     // Validate acquire token call first.
                     validateAcquireTokenRequest(authRequest);
@@ -131,7 +162,7 @@ class AcquireTokenRequest {
 
         // Execute all the calls inside Runnable to return immediately. All UI
         // related actions will be performed using Handler.
-        THREAD_EXECUTOR.execute(new Runnable() {
+        THREAD_EXECUTOR.execute(getSerializationKey(authenticationRequest), new Runnable() {
             @Override
             public void run() {
                 try {
@@ -156,6 +187,17 @@ class AcquireTokenRequest {
         });
     }
 
+    /**
+     * Requests that would read or write the same token cache entry share a key so that they
+     * are never run concurrently. Refresh token redemptions, which are shared across resources,
+     * are additionally serialized per family inside {@link AcquireTokenSilentHandler}.
+     */
+    private static String getSerializationKey(final AuthenticationRequest request) {
+        final String user = request.getUserFromRequest();
+        return (request.getAuthority() + "$" + request.getResource() + "$" + request.getClientId() + "$"
+                + (user == null ? "" : user)).toLowerCase(Locale.US);
+    }
+
     private void validateAcquireTokenRequest(final AuthenticationRequest authenticationRequest)
             throws AuthenticationException {
         final URL authorityUrl = StringExtensions.getUrl(authenticationRequest.getAuthority());
@@ -619,7 +661,7 @@ class AcquireTokenRequest {
                         // immediately to
                         // UI thread. All UI
                         // related actions will be performed using the Handler.
-                        THREAD_EXECUTOR.execute(new Runnable() {
+                        THREAD_EXECUTOR.execute(getSerializationKey(waitingRequest.getRequest()), new Runnable() {
 
                             @Override
                             public void run() {
@@ -25,6 +25,7 @@ package com.cordova.plugin.oidc;
 import android.content.Context;
 
 import java.io.IOException;
+import java.util.Locale;
 
 /**
  * Internal class handling the detailed acquiretoken silent logic, including cache lookup and also
@@ -32,6 +33,20 @@ import java.io.IOException;
  */
 class AcquireTokenSilentHandler {
     private static final String TAG = AcquireTokenSilentHandler.class.getSimpleName();
+
+    /**
+     * Refresh tokens are shared by every resource of a (authority, client, user) family, while
+     * token requests are only serialized per resource. Redemptions for one family take the
+     * same lock so that two resources never redeem the same multi resource refresh token.
+     * Families are striped over a fixed set of locks, a collision only serializes more.
+     */
+    private static final Object[] REFRESH_LOCKS = new Object[16];
+
+    static {
+        for (int i = 0; i < REFRESH_LOCKS.length; i++) {
+            REFRESH_LOCKS[i] = new Object();
+        }
+    }
     
     private final Context mContext;
     private final TokenCacheAccessor mTokenCacheAccessor;
@@ -99,13 +114,31 @@ class AcquireTokenSilentHandler {
         // Check for if there is valid access token item in the cache.
         final TokenCacheItem accessTokenItem = mTokenCacheAccessor.getATFromCache(mAuthRequest.getResource(), 
                 mAuthRequest.getClientId(), mAuthRequest.getUserFromRequest());
-        if (accessTokenItem == null) {
+        if (accessTokenItem != null) {
+            Logger.v(TAG, "Return AT from cache.");
+            return AuthenticationResult.createResult(accessTokenItem);
+        }
+
+        synchronized (getRefreshLock()) {
+            // Another request of this family may have redeemed the refresh token while we waited,
+            // look again so that the rotated refresh token or the new access token is used.
+            final TokenCacheItem refreshedAccessTokenItem = mTokenCacheAccessor.getATFromCache(
+                    mAuthRequest.getResource(), mAuthRequest.getClientId(), mAuthRequest.getUserFromRequest());
+            if (refreshedAccessTokenItem != null) {
+                Logger.v(TAG, "Return AT from cache, refreshed by a concurrent request.");
+                return AuthenticationResult.createResult(refreshedAccessTokenItem);
+            }
+
             Logger.v(TAG, "No valid access token exists, try with refresh token.");
             return tryRT();
         }
-        
-        Logger.v(TAG, "Return AT from cache.");
-        return AuthenticationResult.createResult(accessTokenItem);
+    }
+
+    private Object getRefreshLock() {
+        final String user = mAuthRequest.getUserFromRequest();
+        final String family = (mAuthRequest.getAuthority() + "$" + mAuthRequest.getClientId() + "$"
+                + (user == null ? "" : user)).toLowerCase(Locale.US);
+        return REFRESH_LOCKS[(family.hashCode() & Integer.MAX_VALUE) % REFRESH_LOCKS.length];
     }
     
     /**
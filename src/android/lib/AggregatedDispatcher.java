@@ -24,9 +24,7 @@
 package com.cordova.plugin.oidc;
 
 import java.util.ArrayList;
-import java.util.HashMap;
 import java.util.List;
-import java.util.Map;
 
 final class AggregatedDispatcher extends DefaultDispatcher {
 
@@ -43,7 +41,6 @@ final class AggregatedDispatcher extends DefaultDispatcher {
      */
     @SuppressWarnings("unchecked")
     synchronized void flush(final String requestId) {
-        final Map<String, String> dispatchMap = new HashMap<>();
         if (getDispatcher() == null) {
             return;
         }
@@ -53,14 +50,18 @@ final class AggregatedDispatcher extends DefaultDispatcher {
             return;
         }
 
+        // The default properties are the same for every event, add them once per request
+        final AggregatedEvent aggregatedEvent = new AggregatedEvent();
+        DefaultEvent.addDefaultParameters(aggregatedEvent);
+
         for (int i = 0; i < events.size(); i++) {
             IEvents event = events.get(i);
 
             // The child class of IEvent that is received here will call its processEvent
-            event.processEvent(dispatchMap);
+            event.processEvent(aggregatedEvent);
         }
 
-        getDispatcher().dispatchEvent(dispatchMap);
+        getDispatcher().dispatchEvent(aggregatedEvent.toDispatchMap());
     }
 
     @SuppressWarnings("unchecked")
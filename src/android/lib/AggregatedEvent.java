@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+package com.cordova.plugin.oidc;
+
+import android.util.Pair;
+
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+/**
+ * Accumulates the properties of all events of one request for {@link AggregatedDispatcher}.
+ * Event counters are kept as integers and only turned into strings once, when the event is dispatched.
+ */
+final class AggregatedEvent {
+    private final Map<String, String> mProperties = new HashMap<>();
+
+    private final Map<String, int[]> mCounters = new HashMap<>();
+
+    void put(final String name, final String value) {
+        mProperties.put(name, value);
+    }
+
+    /**
+     * Copies the properties of the event whose names are in the given set.
+     * @param eventList properties of the event being aggregated
+     * @param propertyNames names collected for this type of event
+     */
+    void collect(final List<Pair<String, String>> eventList, final Set<String> propertyNames) {
+        for (final Pair<String, String> eventPair : eventList) {
+            if (propertyNames.contains(eventPair.first)) {
+                mProperties.put(eventPair.first, eventPair.second);
+            }
+        }
+    }
+
+    /**
+     * Blanks out properties left behind by a previous event of the same type, so that only the
+     * latest event's values are reported.
+     * @param propertyNames names to clear if present
+     */
+    void clearExisting(final Set<String> propertyNames) {
+        for (final String name : propertyNames) {
+            if (mProperties.containsKey(name)) {
+                mProperties.put(name, "");
+            }
+        }
+    }
+
+    void increment(final String counterName) {
+        final int[] counter = mCounters.get(counterName);
+        if (counter == null) {
+            mCounters.put(counterName, new int[] {1});
+        } else {
+            counter[0]++;
+        }
+    }
+
+    Map<String, String> toDispatchMap() {
+        for (final Map.Entry<String, int[]> counter : mCounters.entrySet()) {
+            mProperties.put(counter.getKey(), Integer.toString(counter.getValue()[0]));
+        }
+
+        return mProperties;
+    }
+}
@@ -32,6 +32,7 @@ import android.content.pm.PackageManager;
 import android.os.Bundle;
 import android.os.Looper;
 import android.os.NetworkOnMainThreadException;
+import android.os.SystemClock;
 import androidx.annotation.Nullable;
 import androidx.localbroadcastmanager.content.LocalBroadcastManager;
 import android.util.Log;
@@ -789,7 +790,7 @@ public class AuthenticationContext {
     public void acquireTokenSilentAsync(String resource,
                                         String clientId,
                                         String userId,
-                                        AuthenticationCallback<AuthenticationResult> callback) {
+                                        final AuthenticationCallback<AuthenticationResult> callback) {
         if (!checkPreRequirements(resource, clientId, callback)) {
             // AD FS validation cannot be perfomed, stop executing
             return;
@@ -808,7 +809,21 @@ public class AuthenticationContext {
 
         request.setTelemetryRequestId(requestId);
 
-        createAcquireTokenRequest(apiEvent).acquireToken(null, false, request, callback);
+        final long startNanos = SystemClock.elapsedRealtimeNanos();
+        createAcquireTokenRequest(apiEvent).acquireToken(null, false, request,
+                new AuthenticationCallback<AuthenticationResult>() {
+                    @Override
+                    public void onSuccess(AuthenticationResult result) {
+                        Telemetry.getInstance().recordLatency(Telemetry.SILENT_REQUEST_LATENCY, startNanos);
+                        callback.onSuccess(result);
+                    }
+
+                    @Override
+                    public void onError(Exception exc) {
+                        Telemetry.getInstance().recordLatency(Telemetry.SILENT_REQUEST_LATENCY, startNanos);
+                        callback.onError(exc);
+                    }
+                });
     }
 
     /**
@@ -35,10 +35,9 @@ import android.os.RemoteException;
 import java.io.IOException;
 import java.util.ArrayList;
 import java.util.HashMap;
+import java.util.List;
 import java.util.Map;
 import java.util.Set;
-import java.util.concurrent.ConcurrentHashMap;
-import java.util.concurrent.ConcurrentMap;
 import java.util.concurrent.CountDownLatch;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
@@ -51,9 +50,29 @@ final class BrokerAccountServiceHandler {
     private static final String TAG = BrokerAccountServiceHandler.class.getSimpleName();
     private static final String BROKER_ACCOUNT_SERVICE_INTENT_FILTER = "com.microsoft.workaccount.BrokerAccount";
 
-    private ConcurrentMap<BrokerAccountServiceConnection, CallbackExecutor<BrokerAccountServiceConnection>> mPendingConnections = new ConcurrentHashMap<>();
+    /**
+     * How long the broker account service stays bound after the last call on it completed.
+     */
+    private static final long IDLE_UNBIND_DELAY_MILLIS = 30 * 1000;
+
     private static ExecutorService sThreadExecutor = Executors.newCachedThreadPool();
 
+    /**
+     * The connection is shared by all calls and reference counted, it is unbound once no call
+     * has used it for {@link #IDLE_UNBIND_DELAY_MILLIS}.
+     */
+    private final Object mConnectionLock = new Object();
+    private final Handler mMainHandler = new Handler(Looper.getMainLooper());
+    private BrokerAccountServiceConnection mConnection;
+    private int mActiveCalls;
+
+    private final Runnable mIdleUnbind = new Runnable() {
+        @Override
+        public void run() {
+            unbindIfIdle();
+        }
+    };
+
     private static final class InstanceHolder {
         static final BrokerAccountServiceHandler INSTANCE = new BrokerAccountServiceHandler();
     }
@@ -284,18 +303,25 @@ final class BrokerAccountServiceHandler {
     }
 
     private void performAsyncCallOnBound(final Context context, final Callback<BrokerAccountServiceConnection> callback) {
-        bindToBrokerAccountService(context, new Callback<BrokerAccountServiceConnection>() {
+        final CallbackExecutor<BrokerAccountServiceConnection> callbackExecutor = new CallbackExecutor<>(
+                new Callback<BrokerAccountServiceConnection>() {
             @Override
             public void onSuccess(final BrokerAccountServiceConnection result) {
                 if (Looper.myLooper() != Looper.getMainLooper()) {
-                    callback.onSuccess(result);
-                    result.unBindService(context);
+                    try {
+                        callback.onSuccess(result);
+                    } finally {
+                        releaseConnection();
+                    }
                 } else {
                     sThreadExecutor.execute(new Runnable() {
                         @Override
                         public void run() {
-                            callback.onSuccess(result);
-                            result.unBindService(context);
+                            try {
+                                callback.onSuccess(result);
+                            } finally {
+                                releaseConnection();
+                            }
                         }
                     });
                 }
@@ -303,66 +329,218 @@ final class BrokerAccountServiceHandler {
 
             @Override
             public void onError(Throwable throwable) {
-                callback.onError(throwable);
+                try {
+                    callback.onError(throwable);
+                } finally {
+                    releaseConnection();
+                }
             }
         });
+
+        final BrokerAccountServiceConnection connection = acquireConnection(context);
+        connection.whenConnected(callbackExecutor);
     }
 
-    private void bindToBrokerAccountService(final Context context, final Callback<BrokerAccountServiceConnection> callback) {
-        Logger.v(TAG, "Binding to BrokerAccountService for caller uid: " + android.os.Process.myUid());
+    /**
+     * Returns the shared connection, creating and binding a new one if there is none or the
+     * previous one was disconnected or is bound to a broker that is no longer the active one.
+     * Each call must be balanced with {@link #releaseConnection()}.
+     */
+    private BrokerAccountServiceConnection acquireConnection(final Context context) {
         final Intent brokerAccountServiceToBind = getIntentForBrokerAccountService(context);
+        final BrokerAccountServiceConnection staleConnection;
+        final BrokerAccountServiceConnection connection;
+        synchronized (mConnectionLock) {
+            mMainHandler.removeCallbacks(mIdleUnbind);
+            mActiveCalls++;
+
+            if (mConnection != null && mConnection.isUsableFor(brokerAccountServiceToBind)) {
+                return mConnection;
+            }
+
+            staleConnection = mConnection;
+            connection = new BrokerAccountServiceConnection(context.getApplicationContext(),
+                    brokerAccountServiceToBind);
+            mConnection = connection;
+        }
+
+        if (staleConnection != null) {
+            // Calls still waiting on the stale bind would never hear back once it is unbound,
+            // fail them so that they release the connection.
+            staleConnection.fail(new IllegalStateException("The active broker changed while binding."));
+        }
+
+        connection.bind();
+        return connection;
+    }
+
+    private void releaseConnection() {
+        synchronized (mConnectionLock) {
+            mActiveCalls--;
+            if (mActiveCalls == 0 && mConnection != null) {
+                mMainHandler.postDelayed(mIdleUnbind, IDLE_UNBIND_DELAY_MILLIS);
+            }
+        }
+    }
+
+    private void unbindIfIdle() {
+        final BrokerAccountServiceConnection connection;
+        synchronized (mConnectionLock) {
+            if (mActiveCalls > 0 || mConnection == null) {
+                return;
+            }
+
+            connection = mConnection;
+            mConnection = null;
+        }
+
+        Logger.v(TAG, "Broker Account service connection is idle, unbinding.");
+        connection.unBindService();
+    }
+
+    /**
+     * Drops the connection so the next call binds again, used when the service died or the bind failed.
+     */
+    private void dropConnection(final BrokerAccountServiceConnection connection) {
+        synchronized (mConnectionLock) {
+            if (mConnection == connection) {
+                mConnection = null;
+            }
+        }
 
-        final BrokerAccountServiceConnection connection = new BrokerAccountServiceConnection();
-        final CallbackExecutor<BrokerAccountServiceConnection> callbackExecutor = new CallbackExecutor<>(callback);
-        mPendingConnections.put(connection, callbackExecutor);
-        context.bindService(brokerAccountServiceToBind, connection, Context.BIND_AUTO_CREATE);
+        connection.unBindService();
     }
 
     private class BrokerAccountServiceConnection implements android.content.ServiceConnection {
+        private final Context mContext;
+        private final Intent mServiceIntent;
+        private final List<CallbackExecutor<BrokerAccountServiceConnection>> mPendingCallbacks = new ArrayList<>();
         private IBrokerAccountService mBrokerAccountService;
+        private Throwable mBindError;
         private boolean mBound;
+        private boolean mDisconnected;
 
-        public IBrokerAccountService getBrokerAccountServiceProvider() {
+        BrokerAccountServiceConnection(final Context context, final Intent serviceIntent) {
+            mContext = context;
+            mServiceIntent = serviceIntent;
+        }
+
+        public synchronized IBrokerAccountService getBrokerAccountServiceProvider() {
             return mBrokerAccountService;
         }
 
+        synchronized boolean isUsableFor(final Intent serviceIntent) {
+            return !mDisconnected && mBindError == null && serviceIntent != null
+                    && serviceIntent.getComponent().equals(mServiceIntent.getComponent());
+        }
+
+        void bind() {
+            Logger.v(TAG, "Binding to BrokerAccountService for caller uid: " + android.os.Process.myUid());
+            if (mServiceIntent == null) {
+                fail(new IllegalStateException("No recognized broker is installed on the device."));
+                return;
+            }
+
+            try {
+                final boolean bound = mContext.bindService(mServiceIntent, this, Context.BIND_AUTO_CREATE);
+                synchronized (this) {
+                    mBound = bound;
+                }
+
+                if (!bound) {
+                    fail(new IllegalStateException("Failed to bind to BrokerAccountService."));
+                }
+            } catch (final SecurityException exception) {
+                fail(exception);
+            }
+        }
+
+        /**
+         * Runs the callback once the service is connected, right away if it already is. Calls
+         * made while the bind is in flight are queued and all run as soon as it completes.
+         */
+        void whenConnected(final CallbackExecutor<BrokerAccountServiceConnection> callbackExecutor) {
+            final Throwable bindError;
+            synchronized (this) {
+                bindError = mBindError;
+                if (bindError == null && mBrokerAccountService == null) {
+                    mPendingCallbacks.add(callbackExecutor);
+                    return;
+                }
+            }
+
+            if (bindError != null) {
+                callbackExecutor.onError(bindError);
+            } else {
+                callbackExecutor.onSuccess(this);
+            }
+        }
+
+        private void fail(final Throwable throwable) {
+            final List<CallbackExecutor<BrokerAccountServiceConnection>> pendingCallbacks;
+            synchronized (this) {
+                mBindError = throwable;
+                pendingCallbacks = new ArrayList<>(mPendingCallbacks);
+                mPendingCallbacks.clear();
+            }
+
+            dropConnection(this);
+            for (final CallbackExecutor<BrokerAccountServiceConnection> callbackExecutor : pendingCallbacks) {
+                callbackExecutor.onError(throwable);
+            }
+        }
+
         @Override
         public void onServiceConnected(ComponentName name, IBinder service) {
             Logger.v(TAG, "Broker Account service is connected.");
-            mBrokerAccountService = IBrokerAccountService.Stub.asInterface(service);
-            mBound = true;
-            final CallbackExecutor<BrokerAccountServiceConnection> callbackExecutor = mPendingConnections.remove(this);
-            if (callbackExecutor != null) {
-                callbackExecutor.onSuccess(this);
-            } else {
+            final List<CallbackExecutor<BrokerAccountServiceConnection>> pendingCallbacks;
+            synchronized (this) {
+                mBrokerAccountService = IBrokerAccountService.Stub.asInterface(service);
+                pendingCallbacks = new ArrayList<>(mPendingCallbacks);
+                mPendingCallbacks.clear();
+            }
+
+            if (pendingCallbacks.isEmpty()) {
                 Logger.v(TAG, "No callback is found.");
             }
+
+            for (final CallbackExecutor<BrokerAccountServiceConnection> callbackExecutor : pendingCallbacks) {
+                callbackExecutor.onSuccess(this);
+            }
         }
 
         @Override
         public void onServiceDisconnected(ComponentName name) {
             Logger.v(TAG, "Broker Account service is disconnected.");
-            mBound = false;
+            synchronized (this) {
+                mDisconnected = true;
+            }
+
+            // The broker process died, bind a fresh connection on the next call.
+            dropConnection(this);
         }
 
-        public void unBindService(final Context context) {
+        public void unBindService() {
             // Service disconnect is async operation, in case of race condition, having the service binding check queued up
             // in main message looper and unbind it.
-            final Handler handler = new Handler(Looper.getMainLooper());
-            handler.post(new Runnable() {
+            mMainHandler.post(new Runnable() {
                 @Override
                 public void run() {
-                    if (mBound) {
-                        try {
-                            context.unbindService(BrokerAccountServiceConnection.this);
-                        } catch (final IllegalArgumentException exception) {
-                            // unbindService throws "Service not registered" IllegalArgumentException. We are still investigating
-                            // why this is happening. Meanwhile to unblock the release we are adding this workaround.
-                            // Issue #808 tracks the future investigation.
-                            Logger.e(TAG, "Unbind threw IllegalArgumentException", "", null, exception);
-                        } finally {
-                            mBound = false;
+                    synchronized (BrokerAccountServiceConnection.this) {
+                        if (!mBound) {
+                            return;
                         }
+
+                        mBound = false;
+                    }
+
+                    try {
+                        mContext.unbindService(BrokerAccountServiceConnection.this);
+                    } catch (final IllegalArgumentException exception) {
+                        // unbindService throws "Service not registered" IllegalArgumentException. We are still investigating
+                        // why this is happening. Meanwhile to unblock the release we are adding this workaround.
+                        // Issue #808 tracks the future investigation.
+                        Logger.e(TAG, "Unbind threw IllegalArgumentException", "", null, exception);
                     }
                 }
             });
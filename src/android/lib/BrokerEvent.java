@@ -23,12 +23,16 @@
 
 package com.cordova.plugin.oidc;
 
-import android.util.Pair;
-
-import java.util.List;
-import java.util.Map;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
 
 final class BrokerEvent extends DefaultEvent {
+    private static final Set<String> AGGREGATED_PROPERTIES = new HashSet<>(Arrays.asList(
+            EventStrings.BROKER_APP,
+            EventStrings.BROKER_VERSION
+    ));
+
     BrokerEvent(final String eventName) {
         setProperty(EventStrings.EVENT_NAME, eventName);
     }
@@ -43,19 +47,11 @@ final class BrokerEvent extends DefaultEvent {
 
     /**
      * Each event chooses which of its members get picked on aggregation.
-     * @param dispatchMap the Map that is filled with the aggregated event properties
+     * @param aggregatedEvent the aggregated event properties of the request
      */
     @Override
-    public void processEvent(final Map<String, String> dispatchMap) {
-        final List<Pair<String, String>> eventList = getEventList();
-
-        dispatchMap.put(EventStrings.BROKER_APP_USED, "true");
-        for (Pair<String, String> eventPair : eventList) {
-            final String name = eventPair.first;
-
-            if (name.equals(EventStrings.BROKER_APP) || name.equals(EventStrings.BROKER_VERSION)) {
-                dispatchMap.put(name, eventPair.second);
-            }
-        }
+    public void processEvent(final AggregatedEvent aggregatedEvent) {
+        aggregatedEvent.put(EventStrings.BROKER_APP_USED, "true");
+        aggregatedEvent.collect(getEventList(), AGGREGATED_PROPERTIES);
     }
 }
@@ -27,12 +27,15 @@ import android.accounts.AccountManager;
 import android.accounts.AccountManagerFuture;
 import android.accounts.AuthenticatorDescription;
 import android.accounts.AuthenticatorException;
+import android.accounts.OnAccountsUpdateListener;
 import android.accounts.OperationCanceledException;
 import android.annotation.SuppressLint;
 import android.annotation.TargetApi;
 import android.app.Activity;
+import android.content.BroadcastReceiver;
 import android.content.Context;
 import android.content.Intent;
+import android.content.IntentFilter;
 import android.content.SharedPreferences;
 import android.content.SharedPreferences.Editor;
 import android.content.pm.PackageInfo;
@@ -44,6 +47,7 @@ import android.os.Build;
 import android.os.Bundle;
 import android.os.Handler;
 import android.os.Looper;
+import android.os.SystemClock;
 import android.text.TextUtils;
 import android.util.Base64;
 
@@ -68,7 +72,10 @@ import java.util.Calendar;
 import java.util.Collections;
 import java.util.Date;
 import java.util.GregorianCalendar;
+import java.util.HashMap;
 import java.util.List;
+import java.util.Map;
+import java.util.concurrent.atomic.AtomicBoolean;
 
 /**
  * Handles interactions to authenticator inside the Account Manager.
@@ -98,6 +105,27 @@ class BrokerProxy implements IBrokerProxy {
 
     private static final String AUTHENTICATOR_CANCELS_REQUEST = "Authenticator cancels the request";
 
+    /**
+     * Broker users are re-queried after this long even without an account change notification,
+     * the listener is not guaranteed to see broker accounts on every API level.
+     */
+    private static final long BROKER_USERS_CACHE_TTL_MILLIS = 10 * 1000;
+
+    private static final AtomicBoolean CACHE_INVALIDATION_REGISTERED = new AtomicBoolean(false);
+
+    /**
+     * Signature verification results keyed by package name and expected broker signature. Cleared
+     * whenever a package is added, replaced, changed or removed.
+     */
+    private static final Map<String, Boolean> VERIFIED_PACKAGES = new HashMap<>();
+    private static long sVerifiedPackagesGeneration;
+
+    private static final Object BROKER_USERS_LOCK = new Object();
+    private static UserInfo[] sBrokerUsers;
+    private static String sBrokerUsersPackageName;
+    private static long sBrokerUsersExpiresAt;
+    private static long sBrokerUsersGeneration;
+
     public BrokerProxy() {
         mBrokerTag = AuthenticationSettings.INSTANCE.getBrokerSignature();
     }
@@ -107,6 +135,58 @@ class BrokerProxy implements IBrokerProxy {
         mAcctManager = AccountManager.get(mContext);
         mHandler = new Handler(mContext.getMainLooper());
         mBrokerTag = AuthenticationSettings.INSTANCE.getBrokerSignature();
+        registerCacheInvalidation(mContext.getApplicationContext());
+    }
+
+    /**
+     * Registers, once per process, for the package and account changes that invalidate the
+     * verified broker packages and the broker user list.
+     */
+    private static void registerCacheInvalidation(final Context appContext) {
+        if (!CACHE_INVALIDATION_REGISTERED.compareAndSet(false, true)) {
+            return;
+        }
+
+        final IntentFilter packageFilter = new IntentFilter();
+        packageFilter.addAction(Intent.ACTION_PACKAGE_ADDED);
+        packageFilter.addAction(Intent.ACTION_PACKAGE_REPLACED);
+        packageFilter.addAction(Intent.ACTION_PACKAGE_CHANGED);
+        packageFilter.addAction(Intent.ACTION_PACKAGE_REMOVED);
+        packageFilter.addDataScheme("package");
+        appContext.registerReceiver(new BroadcastReceiver() {
+            @Override
+            public void onReceive(final Context context, final Intent intent) {
+                Logger.v(TAG, "Package change received, clearing broker verification and user caches.");
+                invalidateVerifiedPackages();
+                invalidateBrokerUsers();
+            }
+        }, packageFilter);
+
+        try {
+            AccountManager.get(appContext).addOnAccountsUpdatedListener(new OnAccountsUpdateListener() {
+                @Override
+                public void onAccountsUpdated(final Account[] accounts) {
+                    invalidateBrokerUsers();
+                }
+            }, null, false);
+        } catch (final SecurityException exception) {
+            Logger.w(TAG, "Can't listen for account changes, broker users are only refreshed on expiry.",
+                    exception.getMessage(), null);
+        }
+    }
+
+    private static void invalidateVerifiedPackages() {
+        synchronized (VERIFIED_PACKAGES) {
+            VERIFIED_PACKAGES.clear();
+            sVerifiedPackagesGeneration++;
+        }
+    }
+
+    static void invalidateBrokerUsers() {
+        synchronized (BROKER_USERS_LOCK) {
+            sBrokerUsers = null;
+            sBrokerUsersGeneration++;
+        }
     }
 
     enum SwitchToBroker {
@@ -506,6 +586,7 @@ class BrokerProxy implements IBrokerProxy {
                 } else {
                     removeAccountFromAccountManager();
                 }
+                invalidateBrokerUsers();
             }
         }).start();
     }
@@ -689,8 +770,8 @@ class BrokerProxy implements IBrokerProxy {
 
             final UserInfo[] users;
             try {
-                users = BrokerAccountServiceHandler.getInstance().getBrokerUsers(mContext);
-            } catch (final IOException e) {
+                users = getBrokerUsers();
+            } catch (final IOException | AuthenticatorException | OperationCanceledException e) {
                 Logger.e(TAG, "No current user could be retrieved.", "", null, e);
                 return null;
             }
@@ -778,6 +859,30 @@ class BrokerProxy implements IBrokerProxy {
     }
 
     private boolean verifySignature(final String brokerPackageName) {
+        final String cacheKey = brokerPackageName + KEY_ACCOUNT_LIST_DELIM + mBrokerTag;
+        final long generation;
+        synchronized (VERIFIED_PACKAGES) {
+            final Boolean verified = VERIFIED_PACKAGES.get(cacheKey);
+            if (verified != null) {
+                return verified;
+            }
+
+            generation = sVerifiedPackagesGeneration;
+        }
+
+        Telemetry.getInstance().incrementCounter(Telemetry.BROKER_SIGNATURE_CHECK_COUNT);
+        final boolean verified = verifySignatureOfPackage(brokerPackageName);
+        synchronized (VERIFIED_PACKAGES) {
+            // Don't cache a result for a package that changed while it was being verified
+            if (generation == sVerifiedPackagesGeneration) {
+                VERIFIED_PACKAGES.put(cacheKey, verified);
+            }
+        }
+
+        return verified;
+    }
+
+    private boolean verifySignatureOfPackage(final String brokerPackageName) {
         try {
             // Read all the certificates associated with the package name. In higher version of
             // android sdk, package manager will only returned the cert that is used to sign the
@@ -914,7 +1019,8 @@ class BrokerProxy implements IBrokerProxy {
 
     /**
      * Waits on AccountManager results, so it should not be called on main
-     * thread.
+     * thread. Results are cached briefly and dropped when the broker's accounts
+     * or packages change.
      *
      * @throws IOException
      * @throws AuthenticatorException
@@ -928,11 +1034,35 @@ class BrokerProxy implements IBrokerProxy {
             throw new IllegalArgumentException("Calling getBrokerUsers on main thread");
         }
 
+        final String brokerPackageName = getCurrentActiveBrokerPackageName();
+        final long generation;
+        synchronized (BROKER_USERS_LOCK) {
+            if (sBrokerUsers != null && SystemClock.elapsedRealtime() < sBrokerUsersExpiresAt
+                    && TextUtils.equals(brokerPackageName, sBrokerUsersPackageName)) {
+                return sBrokerUsers.clone();
+            }
+
+            generation = sBrokerUsersGeneration;
+        }
+
+        Telemetry.getInstance().incrementCounter(Telemetry.BROKER_ACCOUNT_QUERY_COUNT);
+        final UserInfo[] users;
         if (isBrokerAccountServiceSupported()) {
-            return BrokerAccountServiceHandler.getInstance().getBrokerUsers(mContext);
+            users = BrokerAccountServiceHandler.getInstance().getBrokerUsers(mContext);
+        } else {
+            users = getUserInfoFromAccountManager();
         }
 
-        return getUserInfoFromAccountManager();
+        synchronized (BROKER_USERS_LOCK) {
+            // Accounts changed while querying, the result may already be stale
+            if (generation == sBrokerUsersGeneration) {
+                sBrokerUsers = users.clone();
+                sBrokerUsersPackageName = brokerPackageName;
+                sBrokerUsersExpiresAt = SystemClock.elapsedRealtime() + BROKER_USERS_CACHE_TTL_MILLIS;
+            }
+        }
+
+        return users;
     }
 
     private UserInfo[] getUserInfoFromAccountManager() throws OperationCanceledException, AuthenticatorException, IOException {
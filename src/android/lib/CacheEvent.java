@@ -25,10 +25,17 @@ package com.cordova.plugin.oidc;
 
 import android.util.Pair;
 
-import java.util.List;
-import java.util.Map;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
 
 final class CacheEvent extends DefaultEvent {
+    private static final Set<String> AGGREGATED_PROPERTIES = new HashSet<>(Arrays.asList(
+            EventStrings.TOKEN_TYPE_IS_FRT,
+            EventStrings.TOKEN_TYPE_IS_MRRT,
+            EventStrings.TOKEN_TYPE_IS_RT
+    ));
+
     private final String mEventName;
 
     CacheEvent(final String eventName) {
@@ -55,38 +62,19 @@ final class CacheEvent extends DefaultEvent {
     /**
      * Each event chooses which of its members get picked on aggregation.
      * Cache event adds an event count field
-     * @param dispatchMap the Map that is filled with the aggregated event properties
+     * @param aggregatedEvent the aggregated event properties of the request
      */
     @Override
-    public void processEvent(final Map<String, String> dispatchMap) {
-
+    public void processEvent(final AggregatedEvent aggregatedEvent) {
         if (mEventName != EventStrings.TOKEN_CACHE_LOOKUP) {
             return;
         }
 
-        final List<Pair<String, String>> eventList = getEventList();
-
-        // We are keeping track of the number of Cache Events here, first time we insert the CACHE_EVENT_COUNT in the
-        // map, next time onwards, we read the value of it and increment by one.
-        final String count = dispatchMap.get(EventStrings.CACHE_EVENT_COUNT);
-        if (count == null) {
-            dispatchMap.put(EventStrings.CACHE_EVENT_COUNT, "1");
-        } else {
-            dispatchMap.put(EventStrings.CACHE_EVENT_COUNT,
-                    Integer.toString(Integer.parseInt(count) + 1));
-        }
-
-        dispatchMap.put(EventStrings.TOKEN_TYPE_IS_FRT, "");
-        dispatchMap.put(EventStrings.TOKEN_TYPE_IS_MRRT, "");
-        dispatchMap.put(EventStrings.TOKEN_TYPE_IS_RT, "");
-
-        for (Pair<String, String> eventPair : eventList) {
-            final String name = eventPair.first;
+        aggregatedEvent.increment(EventStrings.CACHE_EVENT_COUNT);
 
-            if (name.equals(EventStrings.TOKEN_TYPE_IS_FRT) || name.equals(EventStrings.TOKEN_TYPE_IS_RT)
-                    || name.equals(EventStrings.TOKEN_TYPE_IS_MRRT)) {
-                dispatchMap.put(name, eventPair.second);
-            }
+        for (final String name : AGGREGATED_PROPERTIES) {
+            aggregatedEvent.put(name, "");
         }
+        aggregatedEvent.collect(getEventList(), AGGREGATED_PROPERTIES);
     }
 }
@@ -35,7 +35,6 @@ import java.security.NoSuchAlgorithmException;
 import java.util.ArrayList;
 import java.util.Collections;
 import java.util.List;
-import java.util.Map;
 
 
 class DefaultEvent implements IEvents {
@@ -91,24 +90,29 @@ class DefaultEvent implements IEvents {
 
     /**
      * Each event chooses which of its members get picked on aggregation.
-     * @param dispatchMap the Map that is filled with the aggregated event properties
+     * The default properties are shared by all events and are added once per request by
+     * {@link #addDefaultParameters(AggregatedEvent)}, so there is nothing to collect here.
+     * @param aggregatedEvent the aggregated event properties of the request
      */
     @Override
-    public void processEvent(final Map<String, String> dispatchMap) {
+    public void processEvent(final AggregatedEvent aggregatedEvent) {
+    }
+
+    static void addDefaultParameters(final AggregatedEvent aggregatedEvent) {
         if (sApplicationName != null) {
-            dispatchMap.put(EventStrings.APPLICATION_NAME, sApplicationName);
+            aggregatedEvent.put(EventStrings.APPLICATION_NAME, sApplicationName);
         }
 
         if (sApplicationVersion != null) {
-            dispatchMap.put(EventStrings.APPLICATION_VERSION, sApplicationVersion);
+            aggregatedEvent.put(EventStrings.APPLICATION_VERSION, sApplicationVersion);
         }
 
         if (sClientId != null) {
-            dispatchMap.put(EventStrings.CLIENT_ID, sClientId);
+            aggregatedEvent.put(EventStrings.CLIENT_ID, sClientId);
         }
 
         if (sDeviceId != null) {
-            dispatchMap.put(EventStrings.DEVICE_ID, sDeviceId);
+            aggregatedEvent.put(EventStrings.DEVICE_ID, sDeviceId);
         }
     }
 
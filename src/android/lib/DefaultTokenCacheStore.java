@@ -28,15 +28,16 @@ import java.security.GeneralSecurityException;
 import java.util.ArrayList;
 import java.util.Calendar;
 import java.util.Date;
-import java.util.HashSet;
 import java.util.Iterator;
 import java.util.List;
 import java.util.Map;
 import java.util.Map.Entry;
 import java.util.Set;
+import java.util.concurrent.atomic.AtomicBoolean;
 
 import com.google.gson.Gson;
 import com.google.gson.GsonBuilder;
+import com.google.gson.JsonParseException;
 
 import android.annotation.SuppressLint;
 import android.app.Activity;
@@ -45,11 +46,18 @@ import android.content.SharedPreferences;
 import android.content.SharedPreferences.Editor;
 import android.content.pm.PackageManager.NameNotFoundException;
 import android.os.Build;
+import android.os.SystemClock;
 
 /**
  * Store/Retrieve TokenCacheItem from private SharedPreferences.
  * SharedPreferences saves items when it is committed in an atomic operation.
  * One more retry is attempted in case there is a lock in commit.
+ * <p>
+ * Items are written as AES-GCM (E2) blobs, and items in the older E1 format are re-encrypted.
+ * Library versions before E2 can't decrypt those blobs and remove them, so downgrading the
+ * app clears the token cache and users have to sign in again. A store shared with other apps
+ * through {@link AuthenticationSettings#setSharedPrefPackageName(String)} may be read by such
+ * versions, so it keeps writing E1 blobs and is not migrated.
  */
 public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuery {
 
@@ -57,11 +65,16 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
 
     private static final String SHARED_PREFERENCE_NAME = "com.cordova.plugin.oidc.cache";
 
+    private static final String INDEX_SHARED_PREFERENCE_NAME = "com.cordova.plugin.oidc.cache.index";
+
     private static final String TAG = "DefaultTokenCacheStore";
 
     private SharedPreferences mPrefs;
     private Context mContext;
 
+    // Shared with other apps that may run an older library version, see class comment
+    private boolean mSharedStore;
+
     private Gson mGson = new GsonBuilder()
     .registerTypeAdapter(Date.class, new DateTimeAdapter())
     .create();
@@ -69,7 +82,19 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
     @SuppressLint("StaticFieldLeak")
     private static StorageHelper sHelper;
 
+    // Published only once it has been reconciled with the store, read without LOCK
+    private static volatile TokenCacheIndex sIndex;
+
     private static final Object LOCK = new Object();
+
+    /**
+     * Serializes writes to the store so that re-encrypting a legacy blob can't overwrite a
+     * value that was set or removed after the blob was read.
+     */
+    private static final Object WRITE_LOCK = new Object();
+
+    private static final AtomicBoolean MIGRATION_STARTED = new AtomicBoolean(false);
+
     /**
      * @param context {@link Context}
      */
@@ -79,8 +104,9 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
             throw new IllegalArgumentException("Context is null");
         }
         mContext = context;
-        if (!StringExtensions.isNullOrBlank(AuthenticationSettings.INSTANCE
-                .getSharedPrefPackageName())) {
+        mSharedStore = !StringExtensions.isNullOrBlank(AuthenticationSettings.INSTANCE
+                .getSharedPrefPackageName());
+        if (mSharedStore) {
             try {
                 // Context is created from specified packagename in order to
                 // use same file. Reading private data is only allowed if apps specify same
@@ -104,6 +130,88 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
         // If it's under API 18 and secretkey is not provided, we should fail upfront to inform 
         // notify developers. 
         validateSecretKeySetting();
+
+        if (!mSharedStore) {
+            startLegacyMigration();
+        }
+    }
+
+    /**
+     * Re-encrypts the items written in a legacy blob format on a background thread, once per
+     * process. Items read before the sweep gets to them are re-encrypted on read.
+     */
+    private void startLegacyMigration() {
+        if (!MIGRATION_STARTED.compareAndSet(false, true)) {
+            return;
+        }
+
+        final Thread migration = new Thread(new Runnable() {
+
+            @Override
+            public void run() {
+                migrateLegacyItems();
+            }
+        }, "OIDCTokenCacheMigration");
+        migration.setDaemon(true);
+        migration.setPriority(Thread.MIN_PRIORITY);
+        migration.start();
+    }
+
+    private void migrateLegacyItems() {
+        final StorageHelper storageHelper = getStorageHelper();
+        int migrated = 0;
+        for (final Entry<String, ?> entry : mPrefs.getAll().entrySet()) {
+            if (!(entry.getValue() instanceof String)) {
+                continue;
+            }
+
+            final String blob = (String) entry.getValue();
+            if (!storageHelper.isLegacyBlob(blob)) {
+                continue;
+            }
+
+            try {
+                if (reEncrypt(entry.getKey(), blob, storageHelper.decrypt(blob))) {
+                    migrated++;
+                }
+            } catch (GeneralSecurityException | IOException | IllegalArgumentException e) {
+                // Leave the item for the read path, which removes blobs that can't be decrypted
+                Logger.w(TAG, "Failed to migrate token cache item", "", OIDCError.DECRYPTION_FAILED);
+            }
+        }
+
+        if (migrated > 0) {
+            Logger.iFormat(TAG, "Migrated %s token cache items to the current encryption format", migrated);
+        }
+    }
+
+    private boolean isLegacyItem(final String blob) {
+        return !mSharedStore && getStorageHelper().isLegacyBlob(blob);
+    }
+
+    /**
+     * Writes the clear text back in the current blob format, unless the stored blob changed
+     * since it was read.
+     * @return true if the item was replaced.
+     */
+    private boolean reEncrypt(final String key, final String legacyBlob, final String clearText) {
+        final String encrypted = encrypt(clearText);
+        if (encrypted == null) {
+            return false;
+        }
+
+        synchronized (WRITE_LOCK) {
+            if (!legacyBlob.equals(mPrefs.getString(key, null))) {
+                return false;
+            }
+
+            final Editor prefsEditor = mPrefs.edit();
+            prefsEditor.putString(key, encrypted);
+            // apply will do Async disk write operation.
+            prefsEditor.apply();
+        }
+
+        return true;
     }
 
     /**
@@ -120,9 +228,84 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
         return sHelper;
     }
 
+    /**
+     * Returns the secondary indexes. They are brought in line with the store when first loaded:
+     * keys written before the index existed are decrypted and indexed, and index entries for
+     * keys that are gone are dropped. Writes through this class keep the index current.
+     */
+    private TokenCacheIndex getIndex() {
+        TokenCacheIndex index = sIndex;
+        if (index != null) {
+            return index;
+        }
+
+        synchronized (LOCK) {
+            if (sIndex == null) {
+                index = new TokenCacheIndex(mContext.getSharedPreferences(INDEX_SHARED_PREFERENCE_NAME,
+                        Activity.MODE_PRIVATE));
+                indexStoredItems(index, mPrefs.getAll().keySet());
+                sIndex = index;
+            }
+
+            return sIndex;
+        }
+    }
+
+    /**
+     * Returns the secondary indexes for a query. Items written to a shared store by another
+     * app, e.g. an older library version that doesn't maintain the index, show up as a
+     * difference in the number of keys, in which case the index is reconciled again.
+     */
+    private TokenCacheIndex getIndexForQuery() {
+        final TokenCacheIndex index = getIndex();
+        final Set<String> storedKeys = mPrefs.getAll().keySet();
+        if (storedKeys.size() != index.getTrackedKeyCount()) {
+            synchronized (LOCK) {
+                indexStoredItems(index, storedKeys);
+            }
+        }
+
+        return index;
+    }
+
+    // Must be called while holding LOCK
+    private void indexStoredItems(final TokenCacheIndex index, final Set<String> storedKeys) {
+        final List<String> unindexedKeys = index.reconcile(storedKeys);
+        for (String key : unindexedKeys) {
+            // Items that fail to decrypt are removed from the store by decrypt(). Items that are
+            // still there but can't be read are remembered so that they are not decrypted again.
+            TokenCacheItem item = null;
+            try {
+                item = getItem(key);
+            } catch (final JsonParseException exception) {
+                Logger.w(TAG, "Skipping unreadable cache item while indexing", "",
+                        OIDCError.DEVICE_FILE_CACHE_FORMAT_IS_WRONG);
+            }
+
+            if (item != null) {
+                index.put(key, item);
+            } else if (mPrefs.contains(key)) {
+                index.markUnreadable(key);
+            }
+        }
+    }
+
+    private List<TokenCacheItem> getItems(final List<String> keys) {
+        final List<TokenCacheItem> tokens = new ArrayList<>(keys.size());
+        for (String key : keys) {
+            final TokenCacheItem item = getItem(key);
+            if (item != null) {
+                tokens.add(item);
+            }
+        }
+
+        return tokens;
+    }
+
     private String encrypt(String value) {
         try {
-            return getStorageHelper().encrypt(value);
+            final StorageHelper storageHelper = getStorageHelper();
+            return mSharedStore ? storageHelper.encrypt(value) : storageHelper.encryptGcm(value);
         } catch (GeneralSecurityException | IOException e) {
             Logger.e(TAG, "Encryption failure", "", OIDCError.ENCRYPTION_FAILED, e);
         }
@@ -152,15 +335,24 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
             throw new IllegalArgumentException("The key is null.");
         }
 
-        if (mPrefs.contains(key)) {
-            String json = mPrefs.getString(key, "");
-            String decrypted = decrypt(key, json);
-            if (decrypted != null) {
-                return mGson.fromJson(decrypted, TokenCacheItem.class);
+        final long startNanos = SystemClock.elapsedRealtimeNanos();
+        try {
+            if (mPrefs.contains(key)) {
+                String json = mPrefs.getString(key, "");
+                String decrypted = decrypt(key, json);
+                if (decrypted != null) {
+                    if (isLegacyItem(json)) {
+                        reEncrypt(key, json, decrypted);
+                    }
+
+                    return mGson.fromJson(decrypted, TokenCacheItem.class);
+                }
             }
-        }
 
-        return null;
+            return null;
+        } finally {
+            Telemetry.getInstance().recordLatency(Telemetry.STORAGE_LATENCY, startNanos);
+        }
     }
 
     @Override
@@ -169,11 +361,19 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
             throw new IllegalArgumentException("key");
         }
 
-        if (mPrefs.contains(key)) {
-            Editor prefsEditor = mPrefs.edit();
-            prefsEditor.remove(key);
-            // apply will do Async disk write operation.
-            prefsEditor.apply();
+        synchronized (WRITE_LOCK) {
+            if (mPrefs.contains(key)) {
+                Editor prefsEditor = mPrefs.edit();
+                prefsEditor.remove(key);
+                // apply will do Async disk write operation.
+                prefsEditor.apply();
+            }
+
+            // Not loaded yet, loading reconciles with the store
+            final TokenCacheIndex index = sIndex;
+            if (index != null) {
+                index.remove(key);
+            }
         }
     }
 
@@ -187,25 +387,40 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
             throw new IllegalArgumentException("item");
         }
 
+        final long startNanos = SystemClock.elapsedRealtimeNanos();
         String json = mGson.toJson(item);
         String encrypted = encrypt(json);
         if (encrypted != null) {
-            Editor prefsEditor = mPrefs.edit();
-            prefsEditor.putString(key, encrypted);
+            // Loading the index takes LOCK and may write, so it can't happen under WRITE_LOCK
+            final TokenCacheIndex index = getIndex();
+            synchronized (WRITE_LOCK) {
+                Editor prefsEditor = mPrefs.edit();
+                prefsEditor.putString(key, encrypted);
 
-            // apply will do Async disk write operation.
-            prefsEditor.apply();
+                // apply will do Async disk write operation.
+                prefsEditor.apply();
+
+                index.put(key, item);
+            }
         } else {
             Logger.e(TAG, "Encrypted output is null", "", OIDCError.ENCRYPTION_FAILED);
         }
+        Telemetry.getInstance().recordLatency(Telemetry.STORAGE_LATENCY, startNanos);
     }
 
     @Override
     public void removeAll() {
-        Editor prefsEditor = mPrefs.edit();
-        prefsEditor.clear();
-        // apply will do Async disk write operation.
-        prefsEditor.apply();
+        synchronized (WRITE_LOCK) {
+            Editor prefsEditor = mPrefs.edit();
+            prefsEditor.clear();
+            // apply will do Async disk write operation.
+            prefsEditor.apply();
+
+            final TokenCacheIndex index = sIndex;
+            if (index != null) {
+                index.clear();
+            }
+        }
     }
 
     // Extra helper methods can be implemented here for queries
@@ -220,20 +435,24 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
         @SuppressWarnings("unchecked")
         Map<String, String> results = (Map<String, String>) mPrefs.getAll();
 
+        // Decrypt the whole store in one pass so keys and cipher state are set up once
+        final List<String> failedKeys = new ArrayList<>();
+        final Map<String, String> decryptedResults = getStorageHelper().decryptAll(results, failedKeys);
+        for (final String failedKey : failedKeys) {
+            removeItem(failedKey);
+            Logger.v(TAG, String.format("Decryption error, item removed for key: '%s'", failedKey));
+        }
+
         // create objects
-        final List<TokenCacheItem> tokens = new ArrayList<>(results.values().size());
-        
-        Iterator<Entry<String, String>> tokenResultEntrySet = results.entrySet().iterator();
-        while (tokenResultEntrySet.hasNext()) {
-            final Entry<String, String> tokenEntry = tokenResultEntrySet.next();
-            final String tokenKey = tokenEntry.getKey();
-            final String tokenValue = tokenEntry.getValue();
-            
-            final String decryptedValue = decrypt(tokenKey, tokenValue);
-            if (decryptedValue != null) {
-                final TokenCacheItem tokenCacheItem = mGson.fromJson(decryptedValue, TokenCacheItem.class);
-                tokens.add(tokenCacheItem);
+        final List<TokenCacheItem> tokens = new ArrayList<>(decryptedResults.size());
+        for (final Entry<String, String> decryptedEntry : decryptedResults.entrySet()) {
+            final String blob = results.get(decryptedEntry.getKey());
+            if (isLegacyItem(blob)) {
+                reEncrypt(decryptedEntry.getKey(), blob, decryptedEntry.getValue());
             }
+
+            final TokenCacheItem tokenCacheItem = mGson.fromJson(decryptedEntry.getValue(), TokenCacheItem.class);
+            tokens.add(tokenCacheItem);
         }
 
         return tokens.iterator();
@@ -246,17 +465,7 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
      */
     @Override
     public Set<String> getUniqueUsersWithTokenCache() {
-        Iterator<TokenCacheItem> results = this.getAll();
-        final Set<String> users = new HashSet<>();
-        
-        while (results.hasNext()) {
-            final TokenCacheItem tokenCacheItem = results.next();
-            if (tokenCacheItem.getUserInfo() != null && !users.contains(tokenCacheItem.getUserInfo().getUserId())) {
-                users.add(tokenCacheItem.getUserInfo().getUserId());
-            }
-        }
-
-        return users;
+        return getIndexForQuery().getUsers();
     }
 
     /**
@@ -267,18 +476,8 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
      */
     @Override
     public List<TokenCacheItem> getTokensForResource(String resource) {
-        Iterator<TokenCacheItem> results = this.getAll();
-        final List<TokenCacheItem> tokenItems = new ArrayList<>();
-
-        while (results.hasNext()) {
-            final TokenCacheItem tokenCacheItem = results.next();
-            // MRRT and FRT don't store resource in the token cache item. 
-            if (resource.equals(tokenCacheItem.getResource())) {
-                tokenItems.add(tokenCacheItem);
-            }
-        }
-
-        return tokenItems;
+        // MRRT and FRT don't store resource in the token cache item, so they are never indexed by resource.
+        return getItems(getIndexForQuery().getKeysForResource(resource));
     }
 
     /**
@@ -289,18 +488,7 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
      */
     @Override
     public List<TokenCacheItem> getTokensForUser(String userId) {
-        Iterator<TokenCacheItem> results = this.getAll();
-        final List<TokenCacheItem> tokenItems = new ArrayList<>();
-        
-        while (results.hasNext()) {
-            final TokenCacheItem tokenCacheItem = results.next();
-            if (tokenCacheItem.getUserInfo() != null
-                    && tokenCacheItem.getUserInfo().getUserId().equalsIgnoreCase(userId)) {
-                tokenItems.add(tokenCacheItem);
-            }
-        }
-
-        return tokenItems;
+        return getItems(getIndexForQuery().getKeysForUser(userId));
     }
 
     /**
@@ -334,16 +522,15 @@ public class DefaultTokenCacheStore implements ITokenCacheStore, ITokenStoreQuer
      */
     @Override
     public List<TokenCacheItem> getTokensAboutToExpire() {
-        Iterator<TokenCacheItem> results = this.getAll();
+        final long validity = getTokenValidityTime().getTimeInMillis();
         final List<TokenCacheItem> tokenItems = new ArrayList<>();
 
-        while (results.hasNext()) {
-            final TokenCacheItem tokenCacheItem = results.next();
-                if (isAboutToExpire(tokenCacheItem.getExpiresOn())) {
-                    tokenItems.add(tokenCacheItem);
-                }
+        final List<String> keys = getIndexForQuery().getKeysExpiringBefore(validity);
+        for (TokenCacheItem tokenCacheItem : getItems(keys)) {
+            if (isAboutToExpire(tokenCacheItem.getExpiresOn())) {
+                tokenItems.add(tokenCacheItem);
             }
-
+        }
 
         return tokenItems;
     }
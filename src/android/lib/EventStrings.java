@@ -118,6 +118,10 @@ final class EventStrings {
 
     static final String UI_EVENT_COUNT = "Microsoft.ADAL.ui_event_count";
 
+    static final String QUEUE_DEPTH = "Microsoft.ADAL.queue_depth"; // Android only
+
+    static final String QUEUE_WAIT_TIME = "Microsoft.ADAL.queue_wait_time"; // Android only
+
     static final String HTTP_EVENT_COUNT = "Microsoft.ADAL.http_event_count";
 
     static final String HTTP_PATH = "Microsoft.ADAL.http_path";
@@ -23,13 +23,20 @@
 
 package com.cordova.plugin.oidc;
 
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.EOFException;
 import java.io.File;
 import java.io.FileInputStream;
 import java.io.FileOutputStream;
 import java.io.IOException;
 import java.io.ObjectInputStream;
 import java.io.ObjectOutputStream;
+import java.io.RandomAccessFile;
 import java.util.Iterator;
+import java.util.zip.CRC32;
 
 import android.content.Context;
 
@@ -37,6 +44,13 @@ import android.content.Context;
  * Persisted cache that keeps cache in-memory until write operation. Filename
  * should not be used on another instance of FiletokenCacheStore since read
  * operations are not synced to file.
+ * <p>
+ * The file holds a snapshot of the whole cache. Each mutation is appended as a
+ * small checksummed record to a journal file next to it, so a write costs one
+ * item instead of the whole cache. The journal is folded into a new snapshot,
+ * written to a temporary file and renamed into place, once it grows past
+ * {@link #COMPACTION_THRESHOLD} records. On load the snapshot is read and the
+ * journal replayed up to the first incomplete or corrupt record.
  */
 public class FileTokenCacheStore implements ITokenCacheStore {
 
@@ -45,14 +59,33 @@ public class FileTokenCacheStore implements ITokenCacheStore {
      */
     private static final long serialVersionUID = -8252291336171327870L;
 
-    private static final String TAG = null;
+    private static final String TAG = "FileTokenCacheStore";
+
+    private static final String JOURNAL_SUFFIX = ".journal";
+
+    private static final String SNAPSHOT_TEMP_SUFFIX = ".tmp";
+
+    /**
+     * Number of journal records after which the journal is compacted into the snapshot.
+     */
+    private static final int COMPACTION_THRESHOLD = 256;
+
+    private static final byte OP_SET = 1;
+
+    private static final byte OP_REMOVE = 2;
+
+    private static final byte OP_REMOVE_ALL = 3;
 
     private final File mFile;
 
+    private final File mJournalFile;
+
     private final MemoryTokenCacheStore mInMemoryCache;
 
     private final Object mCacheLock = new Object();
 
+    private int mJournalRecords;
+
     /**
      * It tracks data in memory until it writes that to a file with write
      * operation.
@@ -82,6 +115,7 @@ public class FileTokenCacheStore implements ITokenCacheStore {
         // Initialize cache from file if it exists
         try {
             mFile = new File(directory, fileName);
+            mJournalFile = new File(directory, fileName + JOURNAL_SUFFIX);
 
             if (mFile.exists()) {
                 Logger.v(TAG, "There is previous cache file to load cache.");
@@ -104,6 +138,8 @@ public class FileTokenCacheStore implements ITokenCacheStore {
                 Logger.v(TAG, "There is not any previous cache file to load cache.");
                 mInMemoryCache = new MemoryTokenCacheStore();
             }
+
+            replayJournal();
         } catch (IOException | ClassNotFoundException ex) {
             Logger.e(TAG, "Exception during cache load",
                     ExceptionExtensions.getExceptionMessage(ex),
@@ -128,45 +164,191 @@ public class FileTokenCacheStore implements ITokenCacheStore {
 
     @Override
     public void setItem(String key, TokenCacheItem item) {
-        mInMemoryCache.setItem(key, item);
-        writeToFile();
+        synchronized (mCacheLock) {
+            mInMemoryCache.setItem(key, item);
+            appendToJournal(OP_SET, key, item);
+        }
     }
 
 
     @Override
     public void removeItem(String key) {
-        mInMemoryCache.removeItem(key);
-        writeToFile();
+        synchronized (mCacheLock) {
+            mInMemoryCache.removeItem(key);
+            appendToJournal(OP_REMOVE, key, null);
+        }
     }
 
     @Override
     public void removeAll() {
-        mInMemoryCache.removeAll();
-        writeToFile();
+        synchronized (mCacheLock) {
+            mInMemoryCache.removeAll();
+            appendToJournal(OP_REMOVE_ALL, null, null);
+        }
     }
 
-    private void writeToFile() {
-        synchronized (mCacheLock) {
-            if (mFile != null && mInMemoryCache != null) {
+    /**
+     * Applies the journal on top of the loaded snapshot. A torn or corrupt record, e.g. from a
+     * crash in the middle of an append, ends the replay and is cut off the journal.
+     */
+    private void replayJournal() throws IOException, ClassNotFoundException {
+        if (!mJournalFile.exists()) {
+            return;
+        }
+
+        long validLength = 0;
+        final DataInputStream journal = new DataInputStream(new FileInputStream(mJournalFile));
+        try {
+            while (true) {
+                final byte[] record;
                 try {
+                    final int length = journal.readInt();
+                    final long checksum = journal.readLong();
+                    if (length <= 0 || length > mJournalFile.length()) {
+                        break;
+                    }
 
-                    // FileOutputStream will create the file.
-                    FileOutputStream outputStream = new FileOutputStream(mFile);
-                    ObjectOutputStream objectStream = new ObjectOutputStream(outputStream);
-                    objectStream.writeObject(mInMemoryCache);
-                    objectStream.flush();
-                    objectStream.close();
-                    outputStream.close();
-
-                } catch (IOException ex) {
-                    Logger.e(TAG, "Exception during cache flush",
-                            ExceptionExtensions.getExceptionMessage(ex),
-                            OIDCError.DEVICE_FILE_CACHE_IS_NOT_WRITING_TO_FILE);
+                    record = new byte[length];
+                    journal.readFully(record);
+                    if (checksumOf(record) != checksum) {
+                        break;
+                    }
+                } catch (final EOFException ex) {
+                    break;
                 }
+
+                applyRecord(record);
+                validLength += Integer.SIZE / Byte.SIZE + Long.SIZE / Byte.SIZE + record.length;
+                mJournalRecords++;
+            }
+        } finally {
+            journal.close();
+        }
+
+        if (validLength < mJournalFile.length()) {
+            Logger.w(TAG, "Discarding incomplete cache journal record", "",
+                    OIDCError.DEVICE_FILE_CACHE_FORMAT_IS_WRONG);
+            final RandomAccessFile file = new RandomAccessFile(mJournalFile, "rw");
+            try {
+                file.setLength(validLength);
+            } finally {
+                file.close();
+            }
+        }
+    }
+
+    private void applyRecord(final byte[] record) throws IOException, ClassNotFoundException {
+        final ObjectInputStream input = new ObjectInputStream(new ByteArrayInputStream(record));
+        try {
+            final byte op = input.readByte();
+            switch (op) {
+                case OP_SET:
+                    final String key = input.readUTF();
+                    final Object item = input.readObject();
+                    if (item instanceof TokenCacheItem) {
+                        mInMemoryCache.setItem(key, (TokenCacheItem) item);
+                    }
+                    break;
+                case OP_REMOVE:
+                    mInMemoryCache.removeItem(input.readUTF());
+                    break;
+                case OP_REMOVE_ALL:
+                    mInMemoryCache.removeAll();
+                    break;
+                default:
+                    Logger.w(TAG, "Unknown cache journal record", "",
+                            OIDCError.DEVICE_FILE_CACHE_FORMAT_IS_WRONG);
+                    break;
+            }
+        } finally {
+            input.close();
+        }
+    }
+
+    private void appendToJournal(final byte op, final String key, final TokenCacheItem item) {
+        try {
+            final ByteArrayOutputStream recordBytes = new ByteArrayOutputStream();
+            final ObjectOutputStream recordStream = new ObjectOutputStream(recordBytes);
+            recordStream.writeByte(op);
+            if (key != null) {
+                recordStream.writeUTF(key);
+            }
+            if (item != null) {
+                recordStream.writeObject(item);
+            }
+            recordStream.close();
+            final byte[] record = recordBytes.toByteArray();
+
+            // Header and payload go out in a single write so a crash leaves at most one torn record.
+            final ByteArrayOutputStream framed = new ByteArrayOutputStream(record.length + 12);
+            final DataOutputStream framedStream = new DataOutputStream(framed);
+            framedStream.writeInt(record.length);
+            framedStream.writeLong(checksumOf(record));
+            framedStream.write(record);
+            framedStream.close();
+
+            final FileOutputStream outputStream = new FileOutputStream(mJournalFile, true);
+            try {
+                outputStream.write(framed.toByteArray());
+            } finally {
+                outputStream.close();
+            }
+            mJournalRecords++;
+        } catch (IOException ex) {
+            Logger.e(TAG, "Exception during cache journal write",
+                    ExceptionExtensions.getExceptionMessage(ex),
+                    OIDCError.DEVICE_FILE_CACHE_IS_NOT_WRITING_TO_FILE);
+            // The snapshot is the only way left to persist this mutation.
+            writeSnapshot();
+            return;
+        }
+
+        if (mJournalRecords >= COMPACTION_THRESHOLD) {
+            writeSnapshot();
+        }
+    }
+
+    /**
+     * Writes the whole in-memory cache to a temporary file, atomically renames it over the
+     * snapshot and then empties the journal. If the process dies before the journal is
+     * emptied, replaying it over the new snapshot yields the same state.
+     */
+    private void writeSnapshot() {
+        final File tempFile = new File(mFile.getPath() + SNAPSHOT_TEMP_SUFFIX);
+        try {
+            // FileOutputStream will create the file.
+            FileOutputStream outputStream = new FileOutputStream(tempFile);
+            try {
+                ObjectOutputStream objectStream = new ObjectOutputStream(outputStream);
+                objectStream.writeObject(mInMemoryCache);
+                objectStream.flush();
+                outputStream.getFD().sync();
+                objectStream.close();
+            } finally {
+                outputStream.close();
             }
+
+            if (!tempFile.renameTo(mFile)) {
+                throw new IOException("Failed to rename cache snapshot");
+            }
+
+            if (mJournalFile.exists() && !mJournalFile.delete()) {
+                throw new IOException("Failed to reset cache journal");
+            }
+            mJournalRecords = 0;
+        } catch (IOException ex) {
+            Logger.e(TAG, "Exception during cache flush",
+                    ExceptionExtensions.getExceptionMessage(ex),
+                    OIDCError.DEVICE_FILE_CACHE_IS_NOT_WRITING_TO_FILE);
         }
     }
 
+    private static long checksumOf(final byte[] record) {
+        final CRC32 crc = new CRC32();
+        crc.update(record, 0, record.length);
+        return crc.getValue();
+    }
+
     @Override
     public Iterator<TokenCacheItem> getAll() {
         return mInMemoryCache.getAll();
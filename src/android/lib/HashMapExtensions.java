@@ -23,9 +23,11 @@
 
 package com.cordova.plugin.oidc;
 
+import java.io.IOException;
+import java.io.Reader;
+import java.io.StringReader;
 import java.io.UnsupportedEncodingException;
 import java.util.HashMap;
-import java.util.Iterator;
 import java.util.Map;
 import java.util.StringTokenizer;
 
@@ -33,6 +35,7 @@ import org.json.JSONException;
 import org.json.JSONObject;
 
 import android.text.TextUtils;
+import android.util.JsonReader;
 import android.util.Log;
 
 final class HashMapExtensions {
@@ -99,16 +102,106 @@ final class HashMapExtensions {
      * @throws JSONException
      */
     static Map<String, String> getJsonResponse(HttpWebResponse webResponse) throws JSONException {
-        final Map<String, String> response = new HashMap<>();
         if (webResponse != null && !TextUtils.isEmpty(webResponse.getBody())) {
-            JSONObject jsonObject = new JSONObject(webResponse.getBody());
-            Iterator<?> i = jsonObject.keys();
-            while (i.hasNext()) {
-                String key = (String) i.next();
-                response.put(key, jsonObject.getString(key));
+            return parseJsonObject(webResponse.getBody());
+        }
+        return new HashMap<>();
+    }
+
+    /**
+     * Read the top level members of a JSON object into key value pairs.
+     * @param json JSON object text
+     * @return Map
+     * @throws JSONException
+     */
+    static Map<String, String> parseJsonObject(final String json) throws JSONException {
+        return parseJsonObject(new StringReader(json));
+    }
+
+    /**
+     * Read the top level members of a JSON object into key value pairs. The members are streamed
+     * straight into the map instead of building a {@link JSONObject} first and copying out of it.
+     * Values are in the form {@link JSONObject#getString(String)} returns them, nested objects and
+     * arrays as their JSON text.
+     * @param json reader positioned at the start of the JSON object
+     * @return Map
+     * @throws JSONException
+     */
+    static Map<String, String> parseJsonObject(final Reader json) throws JSONException {
+        final JsonReader reader = new JsonReader(json);
+        try {
+            final Map<String, String> result = new HashMap<>();
+            reader.beginObject();
+            while (reader.hasNext()) {
+                result.put(reader.nextName(), readJsonValue(reader));
+            }
+            reader.endObject();
+            return result;
+        } catch (final IOException | IllegalStateException e) {
+            final JSONException jsonException = new JSONException(e.getMessage());
+            jsonException.initCause(e);
+            throw jsonException;
+        } finally {
+            try {
+                reader.close();
+            } catch (final IOException e) {
+                Log.d(TAG, e.getMessage());
+            }
+        }
+    }
+
+    private static String readJsonValue(final JsonReader reader) throws IOException {
+        switch (reader.peek()) {
+        case BEGIN_OBJECT:
+        case BEGIN_ARRAY:
+            final StringBuilder json = new StringBuilder();
+            appendJsonValue(reader, json);
+            return json.toString();
+        case BOOLEAN:
+            return String.valueOf(reader.nextBoolean());
+        case NULL:
+            reader.nextNull();
+            return String.valueOf(JSONObject.NULL);
+        default:
+            // Strings, and numbers as their literal text
+            return reader.nextString();
+        }
+    }
+
+    private static void appendJsonValue(final JsonReader reader, final StringBuilder json) throws IOException {
+        switch (reader.peek()) {
+        case BEGIN_OBJECT:
+            reader.beginObject();
+            json.append('{');
+            while (reader.hasNext()) {
+                if (json.charAt(json.length() - 1) != '{') {
+                    json.append(',');
+                }
+                json.append(JSONObject.quote(reader.nextName())).append(':');
+                appendJsonValue(reader, json);
+            }
+            reader.endObject();
+            json.append('}');
+            break;
+        case BEGIN_ARRAY:
+            reader.beginArray();
+            json.append('[');
+            while (reader.hasNext()) {
+                if (json.charAt(json.length() - 1) != '[') {
+                    json.append(',');
+                }
+                appendJsonValue(reader, json);
             }
+            reader.endArray();
+            json.append(']');
+            break;
+        case STRING:
+            json.append(JSONObject.quote(reader.nextString()));
+            break;
+        default:
+            json.append(readJsonValue(reader));
+            break;
         }
-        return response;
     }
 
 }
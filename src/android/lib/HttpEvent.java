@@ -26,10 +26,18 @@ package com.cordova.plugin.oidc;
 import android.util.Pair;
 
 import java.net.URL;
-import java.util.List;
-import java.util.Map;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
 
 final class HttpEvent extends DefaultEvent {
+    private static final Set<String> AGGREGATED_PROPERTIES = new HashSet<>(Arrays.asList(
+            EventStrings.HTTP_RESPONSE_CODE,
+            EventStrings.OAUTH_ERROR_CODE,
+            EventStrings.HTTP_PATH,
+            EventStrings.REQUEST_ID_HEADER
+    ));
+
     HttpEvent(final String eventName) {
         getEventList().add(Pair.create(EventStrings.EVENT_NAME, eventName));
     }
@@ -86,44 +94,14 @@ final class HttpEvent extends DefaultEvent {
     /**
      * Each event chooses which of its members get picked on aggregation.
      * Http event adds an event count field
-     * @param dispatchMap the Map that is filled with the aggregated event properties
+     * @param aggregatedEvent the aggregated event properties of the request
      */
     @Override
-    public void processEvent(final Map<String, String> dispatchMap) {
-        final Object countObject = dispatchMap.get(EventStrings.HTTP_EVENT_COUNT);
-
-        if (countObject == null) {
-            dispatchMap.put(EventStrings.HTTP_EVENT_COUNT, "1");
-        } else {
-            dispatchMap.put(EventStrings.HTTP_EVENT_COUNT,
-                    Integer.toString(Integer.parseInt((String) countObject) + 1));
-        }
+    public void processEvent(final AggregatedEvent aggregatedEvent) {
+        aggregatedEvent.increment(EventStrings.HTTP_EVENT_COUNT);
 
         // If there was a previous entry clear out its fields.
-        if (dispatchMap.containsKey(EventStrings.HTTP_RESPONSE_CODE)) {
-            dispatchMap.put(EventStrings.HTTP_RESPONSE_CODE, "");
-        }
-
-        if (dispatchMap.containsKey(EventStrings.OAUTH_ERROR_CODE)) {
-            dispatchMap.put(EventStrings.OAUTH_ERROR_CODE, "");
-        }
-
-        if (dispatchMap.containsKey(EventStrings.HTTP_PATH)) {
-            dispatchMap.put(EventStrings.HTTP_PATH, "");
-        }
-
-        if (dispatchMap.containsKey(EventStrings.REQUEST_ID_HEADER)) {
-            dispatchMap.put(EventStrings.REQUEST_ID_HEADER, "");
-        }
-
-        final List<Pair<String, String>> eventList = getEventList();
-        for (Pair<String, String> eventPair : eventList) {
-            final String name = eventPair.first;
-
-            if (name.equals(EventStrings.HTTP_RESPONSE_CODE) || name.equals(EventStrings.REQUEST_ID_HEADER)
-                    || name.equals(EventStrings.OAUTH_ERROR_CODE) || name.equals(EventStrings.HTTP_PATH)) {
-                dispatchMap.put(name, eventPair.second);
-            }
-        }
+        aggregatedEvent.clearExisting(AGGREGATED_PROPERTIES);
+        aggregatedEvent.collect(getEventList(), AGGREGATED_PROPERTIES);
     }
 }
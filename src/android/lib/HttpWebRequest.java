@@ -24,17 +24,17 @@
 package com.cordova.plugin.oidc;
 
 import android.content.Context;
-import android.os.Build;
 import android.os.Debug;
 import android.os.Process;
 
-import java.io.BufferedReader;
+import java.io.ByteArrayOutputStream;
 import java.io.Closeable;
+import java.io.EOFException;
 import java.io.IOException;
 import java.io.InputStream;
-import java.io.InputStreamReader;
 import java.io.OutputStream;
 import java.net.HttpURLConnection;
+import java.net.SocketException;
 import java.net.URL;
 import java.util.HashMap;
 import java.util.Map;
@@ -52,6 +52,17 @@ class HttpWebRequest {
     private static final int DEBUG_SIMULATE_DELAY = 0;
     private static final int CONNECT_TIME_OUT = AuthenticationSettings.INSTANCE.getConnectTimeOut();
     private static final int READ_TIME_OUT = AuthenticationSettings.INSTANCE.getReadTimeOut();
+
+    /**
+     * Read buffer size, and the initial response buffer when the length is not known up front.
+     */
+    private static final int RESPONSE_BUFFER_SIZE = 4096;
+
+    /**
+     * Upper bound for sizing the response buffer from Content-Length, so a bogus header can't
+     * make us allocate a huge array before reading anything.
+     */
+    private static final int MAX_PRESIZED_RESPONSE_LENGTH = 256 * 1024;
     private final String mRequestMethod;
     private final URL mUrl;
     private final byte[] mRequestContent;
@@ -83,7 +94,7 @@ class HttpWebRequest {
      * setupConnection before sending the request.
      */
     private HttpURLConnection setupConnection() throws IOException {
-        Logger.v(TAG, "HttpWebRequest setupConnection thread:" + android.os.Process.myTid());
+        Logger.vFormat(TAG, "HttpWebRequest setupConnection thread:%d", android.os.Process.myTid());
         if (mUrl == null) {
             throw new IllegalArgumentException("requestURL");
         }
@@ -94,15 +105,13 @@ class HttpWebRequest {
         HttpURLConnection.setFollowRedirects(true);
         final HttpURLConnection connection = HttpUrlConnectionFactory.createHttpUrlConnection(mUrl);
         connection.setConnectTimeout(CONNECT_TIME_OUT);
-        // To prevent EOF exception.
-        if (Build.VERSION.SDK_INT > Build.VERSION_CODES.HONEYCOMB_MR2) {
-            connection.setRequestProperty("Connection", "close");
-        }
+        // Connections are kept alive and pooled per host by the platform. Accept-Encoding is
+        // left unset so the platform negotiates gzip and decompresses transparently.
 
         // Apply the request headers
         final Set<Map.Entry<String, String>> headerEntries = mRequestHeaders.entrySet();
         for (final Map.Entry<String, String> entry : headerEntries) {
-            Logger.v(TAG, "Setting header: " + entry.getKey());
+            Logger.vFormat(TAG, "Setting header: %s", entry.getKey());
             connection.setRequestProperty(entry.getKey(), entry.getValue());
         }
 
@@ -121,8 +130,18 @@ class HttpWebRequest {
      * send the request.
      */
     public HttpWebResponse send() throws IOException {
-        Logger.v(TAG, "HttpWebRequest send thread:" + Process.myTid());
-        final HttpURLConnection connection = setupConnection();
+        Logger.vFormat(TAG, "HttpWebRequest send thread:%d", Process.myTid());
+        return send(false);
+    }
+
+    private HttpWebResponse send(final boolean isRetry) throws IOException {
+        final HttpURLConnection connection;
+        try {
+            connection = setupConnection();
+        } catch (final IOException ex) {
+            return retryAfterStaleConnection(ex, isRetry);
+        }
+
         final HttpWebResponse response;
         InputStream responseStream = null;
         try {
@@ -134,13 +153,18 @@ class HttpWebRequest {
                 // exception in the httpresponse
                 responseStream = connection.getErrorStream();
                 if (responseStream == null) {
-                    throw ex;
+                    // The request has been sent by now, only requests without side effects
+                    // can be sent again.
+                    if (!REQUEST_METHOD_GET.equalsIgnoreCase(mRequestMethod)) {
+                        throw ex;
+                    }
+                    return retryAfterStaleConnection(ex, isRetry);
                 }
             }
             // GET request should read status after getInputStream to make
             // this work for different SDKs
             final int statusCode = connection.getResponseCode();
-            final String responseBody = convertStreamToString(responseStream);
+            final String responseBody = convertStreamToString(responseStream, connection.getContentLength());
 
             // It will only run in debugger and set from outside for testing
             if (Debug.isDebuggerConnected() && DEBUG_SIMULATE_DELAY > 0) {
@@ -156,10 +180,11 @@ class HttpWebRequest {
             Logger.v(TAG, "Response is received");
             response = new HttpWebResponse(statusCode, responseBody, connection.getHeaderFields());
         } finally {
+            // The body has been read to the end, so closing the stream returns the connection to
+            // the pool. We are not disconnecting from network to allow connection to be returned
+            // into the connection pool. If we call disconnect due to buggy implementation we are
+            // not reusing connections.
             safeCloseStream(responseStream);
-            // We are not disconnecting from network to allow connection to be returned into the
-            // connection pool. If we call disconnect due to buggy implementation we are not reusing
-            // connections.
             //if (connection != null) {
             //	connection.disconnect();
             //}
@@ -167,6 +192,24 @@ class HttpWebRequest {
 
         return response;
     }
+
+    /**
+     * Connections are pooled, and the server may have closed an idle one by the time it is
+     * reused. That surfaces as an EOF or a socket reset while connecting or writing the request,
+     * in which case the request is sent once more on a new connection. Once a POST has been
+     * written it is never sent again, since token grants are not idempotent. Timeouts are not
+     * retried since the server may still be processing the request.
+     */
+    private HttpWebResponse retryAfterStaleConnection(final IOException ex, final boolean isRetry)
+            throws IOException {
+        if (isRetry || !(ex instanceof EOFException || ex instanceof SocketException)) {
+            throw ex;
+        }
+
+        Logger.w(TAG, "Connection failed before a response was received, retrying once.", ex.getMessage(),
+                OIDCError.IO_EXCEPTION);
+        return send(true);
+    }
     
     static void throwIfNetworkNotAvailable(final Context context) throws AuthenticationException {
         final DefaultConnectionService connectionService = new DefaultConnectionService(context);
@@ -182,30 +225,29 @@ class HttpWebRequest {
     } 
 
     /**
-     * Convert stream into the string.
+     * Convert stream into the string. The body is read as raw bytes and decoded once, so line
+     * breaks in the response are preserved.
      *
      * @param inputStream {@link InputStream} to be converted to be a string.
+     * @param contentLength Length of the response body if known, -1 otherwise.
      * @return The converted string
      * @throws IOException Thrown when failing to access inputStream stream.
      */
-    private static String convertStreamToString(InputStream inputStream) throws IOException {
-        BufferedReader reader = null;
+    private static String convertStreamToString(final InputStream inputStream, final int contentLength)
+            throws IOException {
         try {
-            reader = new BufferedReader(new InputStreamReader(inputStream));
-            StringBuilder sb = new StringBuilder();
-            String line;
-            while ((line = reader.readLine()) != null) {
-                if (sb.length() > 0) {
-                    sb.append('\n');
-                }
-                sb.append(line);
+            final int initialSize = contentLength > 0
+                    ? Math.min(contentLength, MAX_PRESIZED_RESPONSE_LENGTH) : RESPONSE_BUFFER_SIZE;
+            final ByteArrayOutputStream body = new ByteArrayOutputStream(initialSize);
+            final byte[] buffer = new byte[RESPONSE_BUFFER_SIZE];
+            int read;
+            while ((read = inputStream.read(buffer)) != -1) {
+                body.write(buffer, 0, read);
             }
 
-            return sb.toString();
+            return body.toString(AuthenticationConstants.ENCODING_UTF8);
         } finally {
-            if (reader != null) {
-                reader.close();
-            }
+            inputStream.close();
         }
     }
 
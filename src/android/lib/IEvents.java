@@ -26,7 +26,6 @@ package com.cordova.plugin.oidc;
 import android.util.Pair;
 
 import java.util.List;
-import java.util.Map;
 
 interface IEvents {
     void setProperty(final String name, final String value);
@@ -37,7 +36,7 @@ interface IEvents {
 
     /**
      * Each event chooses which of its members get picked on aggregation.
-     * @param dispatchMap the Map that is filled with the aggregated event properties
+     * @param aggregatedEvent the aggregated event properties of the request
      */
-    void processEvent(final Map<String, String> dispatchMap);
+    void processEvent(final AggregatedEvent aggregatedEvent);
 }
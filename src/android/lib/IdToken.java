@@ -26,11 +26,10 @@ package com.cordova.plugin.oidc;
 import android.util.Base64;
 
 import org.json.JSONException;
-import org.json.JSONObject;
 
+import java.io.ByteArrayInputStream;
+import java.io.InputStreamReader;
 import java.io.UnsupportedEncodingException;
-import java.util.HashMap;
-import java.util.Iterator;
 import java.util.Map;
 
 /**
@@ -144,8 +143,9 @@ class IdToken {
         final byte[] data = Base64.decode(idbody, Base64.URL_SAFE);
 
         try {
-            final String decodedBody = new String(data, "UTF-8");
-            return extractJsonObjects(decodedBody);
+            // Parse the claims straight from the decoded bytes, without a String copy of the body
+            return HashMapExtensions.parseJsonObject(
+                    new InputStreamReader(new ByteArrayInputStream(data), "UTF-8"));
         } catch (UnsupportedEncodingException exception) {
             Logger.e(TAG, "The encoding is not supported.", "", OIDCError.ENCODING_IS_NOT_SUPPORTED, exception);
             throw new AuthenticationException(OIDCError.ENCODING_IS_NOT_SUPPORTED, exception.getMessage(), exception);
@@ -167,15 +167,4 @@ class IdToken {
             throw new AuthenticationException(OIDCError.IDTOKEN_PARSING_FAILURE, "Failed to extract the ClientID");
         }
     }
-
-    private static Map<String, String> extractJsonObjects(final String jsonStr) throws JSONException {
-        final JSONObject jsonObject = new JSONObject(jsonStr);
-        final Map<String, String> responseItems = new HashMap<>();
-        final Iterator<?> i = jsonObject.keys();
-        while (i.hasNext()) {
-            final String key = (String) i.next();
-            responseItems.put(key, jsonObject.getString(key));
-        }
-        return responseItems;
-    }
 }
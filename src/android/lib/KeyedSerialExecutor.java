@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+package com.cordova.plugin.oidc;
+
+import android.os.SystemClock;
+
+import java.util.ArrayDeque;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+/**
+ * Bounded executor that runs tasks for different keys concurrently while keeping tasks
+ * submitted with the same key in submission order, one at a time.
+ * Keys are expected to identify a token cache entry so that requests touching the same
+ * entry never race each other, while a slow token endpoint for one resource doesn't hold up
+ * requests for the others.
+ */
+final class KeyedSerialExecutor {
+
+    private static final String TAG = "KeyedSerialExecutor";
+
+    private static final long KEEP_ALIVE_SECONDS = 30;
+
+    private final ThreadPoolExecutor mExecutor;
+
+    /**
+     * Pending tasks per key. A key is present while a task for it is queued or running.
+     */
+    private final Map<String, ArrayDeque<QueuedTask>> mPendingTasks = new HashMap<>();
+
+    private int mQueueDepth = 0;
+
+    private long mCompletedCount = 0;
+
+    private long mTotalWaitTimeMs = 0;
+
+    private long mMaxWaitTimeMs = 0;
+
+    KeyedSerialExecutor(final String name, final int maxThreads) {
+        mExecutor = new ThreadPoolExecutor(maxThreads, maxThreads, KEEP_ALIVE_SECONDS, TimeUnit.SECONDS,
+                new LinkedBlockingQueue<Runnable>(), new NamedThreadFactory(name));
+        // Don't hold onto idle threads for the life of the process
+        mExecutor.allowCoreThreadTimeOut(true);
+    }
+
+    /**
+     * Queues the task behind any other task with the same key.
+     *
+     * @param key  Serialization key, null keys share one queue.
+     * @param task The task to run.
+     */
+    void execute(final String key, final Runnable task) {
+        final String queueKey = key == null ? "" : key;
+        final QueuedTask queuedTask = new QueuedTask(task);
+        synchronized (mPendingTasks) {
+            mQueueDepth++;
+            ArrayDeque<QueuedTask> tasks = mPendingTasks.get(queueKey);
+            if (tasks != null) {
+                tasks.add(queuedTask);
+                return;
+            }
+
+            tasks = new ArrayDeque<>();
+            tasks.add(queuedTask);
+            mPendingTasks.put(queueKey, tasks);
+        }
+
+        scheduleNext(queueKey);
+    }
+
+    /**
+     * @return Number of tasks that are waiting or running.
+     */
+    int getQueueDepth() {
+        synchronized (mPendingTasks) {
+            return mQueueDepth;
+        }
+    }
+
+    /**
+     * @return Average time in milliseconds tasks spent queued before they started running.
+     */
+    long getAverageWaitTimeMs() {
+        synchronized (mPendingTasks) {
+            return mCompletedCount == 0 ? 0 : mTotalWaitTimeMs / mCompletedCount;
+        }
+    }
+
+    /**
+     * @return Longest time in milliseconds a task spent queued before it started running.
+     */
+    long getMaxWaitTimeMs() {
+        synchronized (mPendingTasks) {
+            return mMaxWaitTimeMs;
+        }
+    }
+
+    private void scheduleNext(final String queueKey) {
+        mExecutor.execute(new Runnable() {
+            @Override
+            public void run() {
+                runNext(queueKey);
+            }
+        });
+    }
+
+    /**
+     * Runs the task at the head of the queue for the key, then hands the next one for the same
+     * key back to the pool, so that a key with a long queue doesn't monopolize a thread.
+     */
+    private void runNext(final String queueKey) {
+        final QueuedTask next;
+        final long waitTimeMs;
+        final int queueDepth;
+        synchronized (mPendingTasks) {
+            next = mPendingTasks.get(queueKey).peek();
+
+            waitTimeMs = SystemClock.elapsedRealtime() - next.mEnqueuedAt;
+            mTotalWaitTimeMs += waitTimeMs;
+            mMaxWaitTimeMs = Math.max(mMaxWaitTimeMs, waitTimeMs);
+            mCompletedCount++;
+            queueDepth = mQueueDepth;
+        }
+        Logger.vFormat(TAG, "Task started after waiting %d ms, queue depth %d", waitTimeMs, queueDepth);
+
+        try {
+            next.mTask.run();
+        } finally {
+            final boolean hasMore;
+            synchronized (mPendingTasks) {
+                mQueueDepth--;
+                final ArrayDeque<QueuedTask> tasks = mPendingTasks.get(queueKey);
+                tasks.poll();
+                hasMore = !tasks.isEmpty();
+                if (!hasMore) {
+                    mPendingTasks.remove(queueKey);
+                }
+            }
+
+            if (hasMore) {
+                scheduleNext(queueKey);
+            }
+        }
+    }
+
+    private static final class QueuedTask {
+        private final Runnable mTask;
+        private final long mEnqueuedAt = SystemClock.elapsedRealtime();
+
+        QueuedTask(final Runnable task) {
+            mTask = task;
+        }
+    }
+
+    private static final class NamedThreadFactory implements ThreadFactory {
+        private final String mName;
+        private final AtomicInteger mCount = new AtomicInteger(1);
+
+        NamedThreadFactory(final String name) {
+            mName = name;
+        }
+
+        @Override
+        public Thread newThread(final Runnable runnable) {
+            return new Thread(runnable, mName + "-" + mCount.getAndIncrement());
+        }
+    }
+}
@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+package com.cordova.plugin.oidc;
+
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.atomic.AtomicLongArray;
+
+/**
+ * Lock-free latency histogram with log-linear buckets, in the style of HdrHistogram.
+ * Values are kept in microseconds with 16 sub-buckets per power of two, so every reported
+ * percentile is within about 6% of the recorded value while the memory stays fixed.
+ */
+public final class LatencyHistogram {
+    private static final int SUB_BUCKET_BITS = 4;
+
+    private static final int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+    // Values are clamped to 2^36 microseconds, roughly 19 hours.
+    private static final int MAX_VALUE_BITS = 36;
+
+    private static final long MAX_VALUE_MICROS = (1L << MAX_VALUE_BITS) - 1;
+
+    private static final int BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+    private final AtomicLongArray mCounts = new AtomicLongArray(BUCKET_COUNT);
+
+    private final AtomicLong mTotalCount = new AtomicLong();
+
+    private final AtomicLong mMaxMicros = new AtomicLong();
+
+    /**
+     * Records one latency sample.
+     *
+     * @param durationNanos elapsed time in nanoseconds, as measured with a monotonic clock
+     */
+    public void recordNanos(final long durationNanos) {
+        final long micros = Math.min(Math.max(TimeUnit.NANOSECONDS.toMicros(durationNanos), 0), MAX_VALUE_MICROS);
+        mCounts.incrementAndGet(getBucketIndex(micros));
+        mTotalCount.incrementAndGet();
+
+        long max = mMaxMicros.get();
+        while (micros > max && !mMaxMicros.compareAndSet(max, micros)) {
+            max = mMaxMicros.get();
+        }
+    }
+
+    /**
+     * @return number of recorded samples
+     */
+    public long getCount() {
+        return mTotalCount.get();
+    }
+
+    /**
+     * @return largest recorded sample in milliseconds
+     */
+    public double getMaxMillis() {
+        return mMaxMicros.get() / 1000.0;
+    }
+
+    /**
+     * Returns the value at or below which the given percentage of samples fall.
+     *
+     * @param percentile percentile in the range 0 to 100, e.g. 99 for p99
+     * @return the percentile value in milliseconds, or 0 if nothing was recorded
+     */
+    public double getPercentileMillis(final double percentile) {
+        final long totalCount = mTotalCount.get();
+        if (totalCount == 0) {
+            return 0;
+        }
+
+        final long target = Math.max(1, (long) Math.ceil(percentile / 100.0 * totalCount));
+        long cumulative = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            cumulative += mCounts.get(i);
+            if (cumulative >= target) {
+                return Math.min(getBucketUpperBound(i), mMaxMicros.get()) / 1000.0;
+            }
+        }
+
+        return getMaxMillis();
+    }
+
+    /**
+     * Clears all recorded samples.
+     */
+    public void reset() {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            mCounts.set(i, 0);
+        }
+        mTotalCount.set(0);
+        mMaxMicros.set(0);
+    }
+
+    private static int getBucketIndex(final long micros) {
+        if (micros < SUB_BUCKET_COUNT) {
+            return (int) micros;
+        }
+
+        final int exponent = 63 - Long.numberOfLeadingZeros(micros);
+        final int subBucket = (int) (micros >>> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+    }
+
+    private static long getBucketUpperBound(final int index) {
+        if (index < SUB_BUCKET_COUNT) {
+            return index;
+        }
+
+        final int shift = index / SUB_BUCKET_COUNT - 1;
+        final long lowerBound = (long) (SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+        return lowerBound + (1L << shift) - 1;
+    }
+}
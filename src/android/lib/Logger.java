@@ -25,8 +25,16 @@ package com.cordova.plugin.oidc;
 
 import java.text.SimpleDateFormat;
 import java.util.Date;
+import java.util.Locale;
 import java.util.TimeZone;
 import java.util.UUID;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.RejectedExecutionHandler;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.ThreadPoolExecutor;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicLong;
 
 import android.annotation.SuppressLint;
 import android.util.Log;
@@ -35,15 +43,38 @@ import android.util.Log;
  * Android log output can. If externalLogger is set, it will use that as well.
  * Usage: Logger.v(TAG, message, additionalMessage, errorCode) to log. Set
  * custom logger: Logger.setExternalLogger(..);
+ * Hot paths should use the vFormat/iFormat overloads so that nothing is
+ * formatted or allocated when the level is disabled. The external logger is
+ * invoked from a single background writer thread, in submission order.
  */
 public class Logger {
 
-    private LogLevel mLogLevel;
+    private volatile LogLevel mLogLevel;
 
     private static final String CUSTOM_LOG_ERROR = "Custom log failed to log message:%s";
 
     static final String DATEFORMAT = "yyyy-MM-dd HH:mm:ss";
 
+    /**
+     * Upper bound on messages waiting for the external logger. Messages past
+     * this bound are dropped and counted rather than blocking the caller.
+     */
+    private static final int MAX_PENDING_EXTERNAL_MESSAGES = 4096;
+
+    private static final ThreadLocal<SimpleDateFormat> UTC_DATE_FORMAT = new ThreadLocal<SimpleDateFormat>() {
+        @SuppressLint("SimpleDateFormat")
+        @Override
+        protected SimpleDateFormat initialValue() {
+            final SimpleDateFormat dateFormat = new SimpleDateFormat(DATEFORMAT);
+            dateFormat.setTimeZone(TimeZone.getTimeZone("UTC"));
+            return dateFormat;
+        }
+    };
+
+    private static final AtomicLong sDroppedExternalMessages = new AtomicLong();
+
+    private static ExecutorService sExternalWriter = null;
+
     /**
      * Log level.
      */
@@ -82,14 +113,14 @@ public class Logger {
     /**
      * one callback logger.
      */
-    private ILogger mExternalLogger = null;
+    private volatile ILogger mExternalLogger = null;
 
     // enabled by default
-    private boolean mAndroidLogEnabled = true;
+    private volatile boolean mAndroidLogEnabled = true;
 
     private static Logger sInstance = new Logger();
 
-    private String mCorrelationId = null;
+    private volatile String mCorrelationId = null;
 
     /**
      * @return logger
@@ -143,14 +174,33 @@ public class Logger {
         this.mExternalLogger = customLogger;
     }
 
-    private static String addMoreInfo(String message) {
+    /**
+     * Checks whether a message at the given level would be logged. Callers
+     * building expensive messages should check this first.
+     *
+     * @param level log level of the message
+     * @return true if messages at this level are logged
+     */
+    public boolean isLoggable(final LogLevel level) {
+        return mLogLevel.compareTo(level) >= 0;
+    }
+
+    /**
+     * @return number of messages dropped because the external logger fell
+     *         behind.
+     */
+    public static long getDroppedMessageCount() {
+        return sDroppedExternalMessages.get();
+    }
+
+    private static String addMoreInfo(final String message) {
+        final StringBuilder msg = new StringBuilder(64 + (message == null ? 0 : message.length()));
+        msg.append(getUTCDateTimeAsString()).append('-').append(getInstance().mCorrelationId).append('-');
         if (message != null) {
-            return getUTCDateTimeAsString() + "-" + getInstance().mCorrelationId + "-" + message
-                    + " ver:" + AuthenticationContext.getVersionName();
+            msg.append(message);
         }
-
-        return getUTCDateTimeAsString() + "-" + getInstance().mCorrelationId + "- ver:"
-                + AuthenticationContext.getVersionName();
+        msg.append(" ver:").append(AuthenticationContext.getVersionName());
+        return msg.toString();
     }
 
     /**
@@ -159,7 +209,7 @@ public class Logger {
      * @param message Body of the message
      */
     public void debug(String tag, String message) {
-        if (mLogLevel.compareTo(LogLevel.Debug) < 0 || StringExtensions.isNullOrBlank(message)) {
+        if (!isLoggable(LogLevel.Debug) || StringExtensions.isNullOrBlank(message)) {
             return;
         }
 
@@ -178,7 +228,7 @@ public class Logger {
      * @param errorCode ADAL error code being logged
      */
     public void verbose(String tag, String message, String additionalMessage, OIDCError errorCode) {
-        if (mLogLevel.compareTo(LogLevel.Verbose) < 0) {
+        if (!isLoggable(LogLevel.Verbose)) {
             return;
         }
 
@@ -197,7 +247,7 @@ public class Logger {
      * @param errorCode ADAL error code being logged
      */
     public void inform(String tag, String message, String additionalMessage, OIDCError errorCode) {
-        if (mLogLevel.compareTo(LogLevel.Info) < 0) {
+        if (!isLoggable(LogLevel.Info)) {
             return;
         }
 
@@ -216,7 +266,7 @@ public class Logger {
      * @param errorCode ADAL error code being logged
      */
     public void warn(String tag, String message, String additionalMessage, OIDCError errorCode) {
-        if (mLogLevel.compareTo(LogLevel.Warn) < 0) {
+        if (!isLoggable(LogLevel.Warn)) {
             return;
         }
 
@@ -259,22 +309,35 @@ public class Logger {
         logCommon(tag, message, additionalMessage, LogLevel.Error, errorCode, err);
     }
 
-    private void logCommon(String tag, String message, String additionalMessage, LogLevel level,
-						   OIDCError errorCode) {
-        message = addMoreInfo(message);
-
-        if (mExternalLogger != null) {
-            try {
-                mExternalLogger.Log(tag, message, additionalMessage, level, errorCode);
-            } catch (Exception e) {
-                // log message as warning to report callback error issue
-                Log.w(tag, String.format(CUSTOM_LOG_ERROR, message));
-            }
+    private void logCommon(final String tag, final String message, final String additionalMessage,
+                           final LogLevel level, final OIDCError errorCode) {
+        final ILogger externalLogger = mExternalLogger;
+        if (externalLogger == null) {
+            return;
         }
+
+        // Decorate here rather than on the writer so the timestamp is taken at the call
+        final String decoratedMessage = addMoreInfo(message);
+
+        getExternalWriter().execute(new Runnable() {
+            @Override
+            public void run() {
+                try {
+                    externalLogger.Log(tag, decoratedMessage, additionalMessage, level, errorCode);
+                } catch (Exception e) {
+                    // log message as warning to report callback error issue
+                    Log.w(tag, String.format(CUSTOM_LOG_ERROR, decoratedMessage));
+                }
+            }
+        });
     }
 
     private void logCommon(String tag, String message, String additionalMessage, LogLevel level,
 						   OIDCError errorCode, Throwable throwable) {
+        if (mExternalLogger == null) {
+            return;
+        }
+
         StringBuilder msg = new StringBuilder();
         if (additionalMessage != null) {
             msg.append(additionalMessage);
@@ -293,8 +356,9 @@ public class Logger {
             msg.append(getCodeName(errorCode)).append(':');
         }
         if (message != null) {
-            message = addMoreInfo(message);
-            msg.append(message);
+            // Logcat records the time itself, it only needs the correlation id and version
+            msg.append(getInstance().mCorrelationId).append('-').append(message)
+                    .append(" ver:").append(AuthenticationContext.getVersionName());
         }
         if (additionalMessage != null) {
             msg.append(' ').append(additionalMessage);
@@ -358,6 +422,90 @@ public class Logger {
         Logger.getInstance().verbose(tag, message, additionalMessage, errorCode);
     }
 
+    /**
+     * Logs a verbose message formatted from the given argument. Nothing is
+     * formatted or allocated when verbose logging is disabled.
+     *
+     * @param tag tag for the log message
+     * @param format format string, see {@link String#format(String, Object...)}
+     * @param arg format argument
+     */
+    public static void vFormat(String tag, String format, Object arg) {
+        if (Logger.getInstance().isLoggable(LogLevel.Verbose)) {
+            Logger.getInstance().verbose(tag, String.format(Locale.US, format, arg), null, null);
+        }
+    }
+
+    /**
+     * Logs a verbose message formatted from a primitive argument, such as a
+     * thread id, without boxing it when verbose logging is disabled.
+     *
+     * @param tag tag for the log message
+     * @param format format string, see {@link String#format(String, Object...)}
+     * @param arg format argument
+     */
+    public static void vFormat(String tag, String format, long arg) {
+        if (Logger.getInstance().isLoggable(LogLevel.Verbose)) {
+            Logger.getInstance().verbose(tag, String.format(Locale.US, format, arg), null, null);
+        }
+    }
+
+    /**
+     * Logs a verbose message formatted from two primitive arguments without
+     * boxing them when verbose logging is disabled.
+     *
+     * @param tag tag for the log message
+     * @param format format string, see {@link String#format(String, Object...)}
+     * @param arg1 first format argument
+     * @param arg2 second format argument
+     */
+    public static void vFormat(String tag, String format, long arg1, long arg2) {
+        if (Logger.getInstance().isLoggable(LogLevel.Verbose)) {
+            Logger.getInstance().verbose(tag, String.format(Locale.US, format, arg1, arg2), null, null);
+        }
+    }
+
+    /**
+     * Logs a verbose message formatted from the given arguments.
+     *
+     * @param tag tag for the log message
+     * @param format format string, see {@link String#format(String, Object...)}
+     * @param arg1 first format argument
+     * @param arg2 second format argument
+     */
+    public static void vFormat(String tag, String format, Object arg1, Object arg2) {
+        if (Logger.getInstance().isLoggable(LogLevel.Verbose)) {
+            Logger.getInstance().verbose(tag, String.format(Locale.US, format, arg1, arg2), null, null);
+        }
+    }
+
+    /**
+     * Logs an informational message formatted from the given argument.
+     *
+     * @param tag tag for the log message
+     * @param format format string, see {@link String#format(String, Object...)}
+     * @param arg format argument
+     */
+    public static void iFormat(String tag, String format, Object arg) {
+        if (Logger.getInstance().isLoggable(LogLevel.Info)) {
+            Logger.getInstance().inform(tag, String.format(Locale.US, format, arg), null, null);
+        }
+    }
+
+    /**
+     * Logs an informational message formatted from the given arguments.
+     *
+     * @param tag tag for the log message
+     * @param format format string, see {@link String#format(String, Object...)}
+     * @param arg1 first format argument
+     * @param arg2 second format argument
+     */
+    public static void iFormat(String tag, String format, Object arg1, Object arg2) {
+        if (Logger.getInstance().isLoggable(LogLevel.Info)) {
+            Logger.getInstance().inform(tag, String.format(Locale.US, format, arg1, arg2), null, null);
+        }
+    }
+
     /**
      * Logs warning message.
      *
@@ -429,12 +577,31 @@ public class Logger {
         return "";
     }
 
-    @SuppressLint("SimpleDateFormat")
-    private static String getUTCDateTimeAsString() {
-        final SimpleDateFormat dateFormat = new SimpleDateFormat(DATEFORMAT);
-        dateFormat.setTimeZone(TimeZone.getTimeZone("UTC"));
-        return dateFormat.format(new Date());
+    private static synchronized ExecutorService getExternalWriter() {
+        if (sExternalWriter == null) {
+            final ThreadPoolExecutor writer = new ThreadPoolExecutor(1, 1, 0L, TimeUnit.MILLISECONDS,
+                    new LinkedBlockingQueue<Runnable>(MAX_PENDING_EXTERNAL_MESSAGES), new ThreadFactory() {
+                        @Override
+                        public Thread newThread(final Runnable runnable) {
+                            final Thread thread = new Thread(runnable, "OIDCLoggerWriter");
+                            thread.setDaemon(true);
+                            return thread;
+                        }
+                    });
+            writer.setRejectedExecutionHandler(new RejectedExecutionHandler() {
+                @Override
+                public void rejectedExecution(final Runnable runnable, final ThreadPoolExecutor executor) {
+                    sDroppedExternalMessages.incrementAndGet();
+                }
+            });
+            sExternalWriter = writer;
+        }
+
+        return sExternalWriter;
+    }
 
+    private static String getUTCDateTimeAsString() {
+        return UTC_DATE_FORMAT.get().format(new Date());
     }
 
     /**
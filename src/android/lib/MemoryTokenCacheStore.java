@@ -58,7 +58,7 @@ public class MemoryTokenCacheStore implements ITokenCacheStore {
             throw new IllegalArgumentException("The input key is null.");
         }
 
-        Logger.v(TAG, "Get Item from cache. Key:" + key);
+        Logger.vFormat(TAG, "Get Item from cache. Key:%s", key);
         synchronized (mCacheLock) {
             return mCache.get(key);
         }
@@ -74,7 +74,7 @@ public class MemoryTokenCacheStore implements ITokenCacheStore {
             throw new IllegalArgumentException("key");
         }
 
-        Logger.v(TAG, "Set Item to cache. Key:" + key);
+        Logger.vFormat(TAG, "Set Item to cache. Key:%s", key);
         synchronized (mCacheLock) {
             mCache.put(key, item);
         }
@@ -86,7 +86,7 @@ public class MemoryTokenCacheStore implements ITokenCacheStore {
             throw new IllegalArgumentException("key");
         }
 
-        Logger.v(TAG, "Remove Item from cache. Key:" + key.hashCode());
+        Logger.vFormat(TAG, "Remove Item from cache. Key:%d", key.hashCode());
         synchronized (mCacheLock) {
             mCache.remove(key);
         }
@@ -117,7 +117,7 @@ public class MemoryTokenCacheStore implements ITokenCacheStore {
             throw new IllegalArgumentException("key");
         }
 
-        Logger.v(TAG, "contains Item from cache. Key:" + key);
+        Logger.vFormat(TAG, "contains Item from cache. Key:%s", key);
         synchronized (mCacheLock) {
             return mCache.get(key) != null;
         }
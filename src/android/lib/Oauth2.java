@@ -25,13 +25,13 @@ package com.cordova.plugin.oidc;
 
 import android.net.Uri;
 import android.os.Build;
+import android.os.SystemClock;
 import android.text.TextUtils;
 import android.util.Base64;
 
 import com.cordova.plugin.oidc.ChallengeResponseBuilder.ChallengeResponse;
 
 import org.json.JSONException;
-import org.json.JSONObject;
 
 import java.io.IOException;
 import java.io.UnsupportedEncodingException;
@@ -42,7 +42,6 @@ import java.net.URLEncoder;
 import java.util.Calendar;
 import java.util.GregorianCalendar;
 import java.util.HashMap;
-import java.util.Iterator;
 import java.util.List;
 import java.util.Map;
 import java.util.UUID;
@@ -324,18 +323,6 @@ class Oauth2 {
         return result;
     }
 
-    private static void extractJsonObjects(Map<String, String> responseItems, String jsonStr)
-            throws JSONException {
-        final JSONObject jsonObject = new JSONObject(jsonStr);
-
-        final Iterator<?> i = jsonObject.keys();
-
-        while (i.hasNext()) {
-            final String key = (String) i.next();
-            responseItems.put(key, jsonObject.getString(key));
-        }
-    }
-
     public AuthenticationResult refreshToken(String refreshToken) throws IOException,
             AuthenticationException {
         final String requestMessage;
@@ -446,6 +433,7 @@ class Oauth2 {
 
     private AuthenticationResult postMessage(String requestMessage, Map<String, String> headers)
             throws IOException, AuthenticationException {
+        final long startNanos = SystemClock.elapsedRealtimeNanos();
         AuthenticationResult result = null;
         final HttpEvent httpEvent = startHttpEvent();
 
@@ -570,6 +558,7 @@ class Oauth2 {
         } finally {
             ClientMetrics.INSTANCE.endClientMetricsRecord(ClientMetricsEndpointType.TOKEN,
                     mRequest.getCorrelationId());
+            Telemetry.getInstance().recordLatency(Telemetry.TOKEN_GRANT_LATENCY, startNanos);
         }
         return result;
     }
@@ -686,9 +675,11 @@ class Oauth2 {
     private AuthenticationResult parseJsonResponse(final String responseBody)
             throws JSONException,
             AuthenticationException {
-        final Map<String, String> responseItems = new HashMap<>();
-        extractJsonObjects(responseItems, responseBody);
-        return processUIResponseParams(responseItems);
+        if (responseBody == null) {
+            throw new JSONException("Response body is null");
+        }
+
+        return processUIResponseParams(HashMapExtensions.parseJsonObject(responseBody));
     }
 
     private HttpEvent startHttpEvent() {
@@ -49,14 +49,20 @@ import java.security.NoSuchAlgorithmException;
 import java.security.SecureRandom;
 import java.security.cert.CertificateException;
 import java.security.spec.AlgorithmParameterSpec;
+import java.util.Arrays;
 import java.util.Calendar;
 import java.util.Date;
+import java.util.IdentityHashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
 import java.util.Locale;
+import java.util.Map;
 
 import javax.crypto.Cipher;
 import javax.crypto.KeyGenerator;
 import javax.crypto.Mac;
 import javax.crypto.SecretKey;
+import javax.crypto.spec.GCMParameterSpec;
 import javax.crypto.spec.IvParameterSpec;
 import javax.crypto.spec.SecretKeySpec;
 import javax.security.auth.x500.X500Principal;
@@ -129,14 +135,46 @@ public class StorageHelper {
     private static final int KEY_VERSION_BLOB_LENGTH = 4;
 
     /**
-     * To keep track of encoding version and related flags.
+     * To keep track of encoding version and related flags. E1 blobs are AES-CBC encrypted
+     * and signed with a separate HMAC.
      */
     private static final String ENCODE_VERSION = "E1";
+
+    /**
+     * E2 blobs are sealed with AES-GCM, which authenticates in the same pass as it encrypts.
+     * Layout after the encode version: Base64(keyVersion + iv + encryptedData + tag), with the
+     * key version bound to the tag as associated data.
+     */
+    private static final String ENCODE_VERSION_GCM = "E2";
+
+    private static final String GCM_BLOB_PREFIX = (char) ('a' + ENCODE_VERSION_GCM.length())
+            + ENCODE_VERSION_GCM;
+
+    private static final String GCM_CIPHER_ALGORITHM = "AES/GCM/NoPadding";
+
+    /**
+     * 96 bit IV, the size GCM is specified for.
+     */
+    private static final int GCM_IV_LENGTH = 12;
+
+    private static final int GCM_TAG_LENGTH_BITS = 128;
     
     private static final int KEY_FILE_SIZE = 1024;
 
     private static final String ANDROID_KEY_STORE = "AndroidKeyStore";
 
+    /**
+     * Cipher and Mac lookups go through the security providers on every getInstance call,
+     * reuse one instance of each per thread instead. Both are re-initialized before each use.
+     */
+    private static final ThreadLocal<Cipher> CIPHER = new ThreadLocal<>();
+
+    private static final ThreadLocal<Mac> MAC = new ThreadLocal<>();
+
+    private static final ThreadLocal<Cipher> GCM_CIPHER = new ThreadLocal<>();
+
+    private static final int MAX_CACHED_HMAC_KEYS = 4;
+
     private final Context mContext;
     private final SecureRandom mRandom;
 
@@ -149,6 +187,17 @@ public class StorageHelper {
     private SecretKey mHMACKey = null;
     private SecretKey mSecretKeyFromAndroidKeyStore = null;
 
+    /**
+     * User provided key, cached together with the raw bytes it was created from.
+     */
+    private SecretKey mUserDefinedKey = null;
+    private byte[] mUserDefinedKeyData = null;
+
+    /**
+     * HMAC keys derived from the data keys, keyed by data key identity.
+     */
+    private final Map<SecretKey, SecretKey> mHMacKeys = new IdentityHashMap<>();
+
     /**
      * Constructor for {@link StorageHelper}.
      * @param context The {@link Context} to create {@link StorageHelper}.
@@ -168,6 +217,26 @@ public class StorageHelper {
      */
     public String encrypt(final String clearText)
             throws GeneralSecurityException, IOException {
+        return encrypt(clearText, false);
+    }
+
+    /**
+     * Encrypt text with current key as an AES-GCM (E2) blob where the API level supports it,
+     * otherwise as an E1 blob. Library versions before E2 can only decrypt E1 blobs, so only
+     * use this for data that no such version reads, e.g. a token cache not shared with other apps.
+     *
+     * @param clearText Clear text to encrypt.
+     * @return Encrypted blob.
+     * @throws GeneralSecurityException for key related exceptions.
+     * @throws IOException For general IO related exceptions.
+     */
+    public String encryptGcm(final String clearText)
+            throws GeneralSecurityException, IOException {
+        return encrypt(clearText, isGcmSupported());
+    }
+
+    private String encrypt(final String clearText, final boolean useGcm)
+            throws GeneralSecurityException, IOException {
         Logger.v(TAG, "Starting encryption");
 
         if (StringExtensions.isNullOrBlank(clearText)) {
@@ -182,14 +251,20 @@ public class StorageHelper {
         final byte[] blobVersion = mBlobVersion.getBytes(AuthenticationConstants.ENCODING_UTF8);
         final byte[] bytes = clearText.getBytes(AuthenticationConstants.ENCODING_UTF8);
 
+        if (useGcm) {
+            final String encryptedText = encryptGcmBytes(mKey, blobVersion, bytes);
+            Logger.v(TAG, "Finished encryption");
+            return encryptedText;
+        }
+
         // IV: Initialization vector that is needed to start CBC
         final byte[] iv = new byte[DATA_KEY_LENGTH];
         mRandom.nextBytes(iv);
         final IvParameterSpec ivSpec = new IvParameterSpec(iv);
 
         // Set to encrypt mode
-        final Cipher cipher = Cipher.getInstance(CIPHER_ALGORITHM);
-        final Mac mac = Mac.getInstance(HMAC_ALGORITHM);
+        final Cipher cipher = getCipher();
+        final Mac mac = getMac();
         cipher.init(Cipher.ENCRYPT_MODE, mKey, ivSpec);
 
         final byte[] encrypted = cipher.doFinal(bytes);
@@ -221,6 +296,44 @@ public class StorageHelper {
         return getEncodeVersionLengthPrefix() + ENCODE_VERSION + encryptedText;
     }
 
+    @TargetApi(Build.VERSION_CODES.KITKAT)
+    private String encryptGcmBytes(final SecretKey key, final byte[] blobVersion, final byte[] bytes)
+            throws GeneralSecurityException, IOException {
+        final byte[] iv = new byte[GCM_IV_LENGTH];
+        mRandom.nextBytes(iv);
+
+        final Cipher cipher = getGcmCipher();
+        cipher.init(Cipher.ENCRYPT_MODE, key, new GCMParameterSpec(GCM_TAG_LENGTH_BITS, iv));
+        cipher.updateAAD(blobVersion);
+
+        // blobVersion, iv, then encrypted data with the tag appended by the cipher
+        final int encryptedIndex = blobVersion.length + iv.length;
+        final byte[] blob = new byte[encryptedIndex + cipher.getOutputSize(bytes.length)];
+        System.arraycopy(blobVersion, 0, blob, 0, blobVersion.length);
+        System.arraycopy(iv, 0, blob, blobVersion.length, iv.length);
+        final int encryptedLength = cipher.doFinal(bytes, 0, bytes.length, blob, encryptedIndex);
+
+        return GCM_BLOB_PREFIX + new String(Base64.encode(blob, 0, encryptedIndex + encryptedLength,
+                Base64.NO_WRAP), AuthenticationConstants.ENCODING_UTF8);
+    }
+
+    /**
+     * Whether the blob was written in an older format than {@link #encryptGcm(String)} produces
+     * on this device, and should be re-encrypted after it has been read.
+     * @param encryptedBlob The blob as it is stored.
+     * @return true if the blob is in a legacy format.
+     */
+    public boolean isLegacyBlob(final String encryptedBlob) {
+        return isGcmSupported() && encryptedBlob != null && !encryptedBlob.startsWith(GCM_BLOB_PREFIX);
+    }
+
+    /**
+     * GCMParameterSpec is only available from KitKat, older devices keep writing E1 blobs.
+     */
+    private static boolean isGcmSupported() {
+        return Build.VERSION.SDK_INT >= Build.VERSION_CODES.KITKAT;
+    }
+
     /**
      * Decrypt encrypted blob with either user provided key or key persisted in AndroidKeyStore. 
      * @param encryptedBlob The blob to decrypt
@@ -231,7 +344,37 @@ public class StorageHelper {
     public String decrypt(final String encryptedBlob)
             throws GeneralSecurityException, IOException {
         Logger.v(TAG, "Starting decryption");
+        final String decrypted = decryptBlob(encryptedBlob);
+        Logger.v(TAG, "Finished decryption");
+        return decrypted;
+    }
+
+    /**
+     * Decrypt a batch of encrypted blobs, e.g. for a scan of the whole token store. Keys, derived
+     * HMAC keys and the Cipher/Mac instances are cached across the batch, and no per item
+     * logging is done.
+     * @param encryptedBlobs The blobs to decrypt, keyed by their storage key.
+     * @param failedKeys Receives the storage keys of the blobs that failed to decrypt.
+     * @return Decrypted clear text keyed by storage key, for the blobs that could be decrypted.
+     */
+    public Map<String, String> decryptAll(final Map<String, String> encryptedBlobs, final List<String> failedKeys) {
+        Logger.vFormat(TAG, "Starting decryption of %d items", (long) encryptedBlobs.size());
+        final Map<String, String> decrypted = new LinkedHashMap<>(encryptedBlobs.size());
+        for (final Map.Entry<String, String> entry : encryptedBlobs.entrySet()) {
+            try {
+                decrypted.put(entry.getKey(), decryptBlob(entry.getValue()));
+            } catch (final GeneralSecurityException | IOException e) {
+                Logger.e(TAG, "Decryption failure", "", OIDCError.DECRYPTION_FAILED, e);
+                failedKeys.add(entry.getKey());
+            }
+        }
+
+        Logger.v(TAG, "Finished decryption");
+        return decrypted;
+    }
 
+    private String decryptBlob(final String encryptedBlob)
+            throws GeneralSecurityException, IOException {
         if (StringExtensions.isNullOrBlank(encryptedBlob)) {
             throw new IllegalArgumentException("Input is empty or null");
         }
@@ -242,22 +385,29 @@ public class StorageHelper {
                     "Encode version length: '%s' is not valid, it must be greater of equal to 0",
                     encodeVersionLength));
         }
-        if (!encryptedBlob.substring(1, 1 + encodeVersionLength).equals(ENCODE_VERSION)) {
+        final String encodeVersion = encryptedBlob.substring(1, 1 + encodeVersionLength);
+        if (!encodeVersion.equals(ENCODE_VERSION) && !encodeVersion.equals(ENCODE_VERSION_GCM)) {
             throw new IllegalArgumentException(String.format(
-                    "Encode version received was: '%s', Encode version supported is: '%s'", encryptedBlob,
-                    ENCODE_VERSION));
+                    "Encode version received was: '%s', Encode versions supported are: '%s', '%s'",
+                    encryptedBlob, ENCODE_VERSION, ENCODE_VERSION_GCM));
         }
 
         final byte[] bytes = Base64
                 .decode(encryptedBlob.substring(1 + encodeVersionLength), Base64.DEFAULT);
+        if (bytes.length < KEY_VERSION_BLOB_LENGTH) {
+            throw new IOException("Invalid byte array input for decryption.");
+        }
 
         // get key version used for this data. If user upgraded to different
         // API level, data needs to be updated
         final String keyVersion = new String(bytes, 0, KEY_VERSION_BLOB_LENGTH,
                 AuthenticationConstants.ENCODING_UTF8);
-        Logger.v(TAG, "Encrypt version:" + keyVersion);
 
         final SecretKey secretKey = getKey(keyVersion);
+        if (encodeVersion.equals(ENCODE_VERSION_GCM)) {
+            return decryptGcm(secretKey, bytes);
+        }
+
         final SecretKey hmacKey = getHMacKey(secretKey);
 
         // byte input array: encryptedData-iv-macDigest
@@ -271,8 +421,8 @@ public class StorageHelper {
         // Calculate digest again and compare to the appended value
         // incoming message: version+encryptedData+IV+Digest
         // Digest of EncryptedData+IV excluding key Version and digest
-        final Cipher cipher = Cipher.getInstance(CIPHER_ALGORITHM);
-        final Mac mac = Mac.getInstance(HMAC_ALGORITHM);
+        final Cipher cipher = getCipher();
+        final Mac mac = getMac();
         mac.init(hmacKey);
         mac.update(bytes, 0, macIndex);
         final byte[] macDigest = mac.doFinal();
@@ -288,10 +438,31 @@ public class StorageHelper {
                 DATA_KEY_LENGTH));
 
         // Decrypt data bytes from 0 to ivindex
-        final String decrypted = new String(cipher.doFinal(bytes, KEY_VERSION_BLOB_LENGTH,
+        return new String(cipher.doFinal(bytes, KEY_VERSION_BLOB_LENGTH,
                 encryptedLength), AuthenticationConstants.ENCODING_UTF8);
-        Logger.v(TAG, "Finished decryption");
-        return decrypted;
+    }
+
+    @TargetApi(Build.VERSION_CODES.KITKAT)
+    private String decryptGcm(final SecretKey secretKey, final byte[] bytes)
+            throws GeneralSecurityException, IOException {
+        if (!isGcmSupported()) {
+            throw new NoSuchAlgorithmException("AES-GCM blobs can not be decrypted on API < 19");
+        }
+
+        // byte input array: keyVersion-iv-encryptedData-tag
+        final int encryptedIndex = KEY_VERSION_BLOB_LENGTH + GCM_IV_LENGTH;
+        if (bytes.length < encryptedIndex + GCM_TAG_LENGTH_BITS / Byte.SIZE) {
+            throw new IOException("Invalid byte array input for decryption.");
+        }
+
+        // Tag verification covers the key version, the iv and the encrypted data
+        final Cipher cipher = getGcmCipher();
+        cipher.init(Cipher.DECRYPT_MODE, secretKey, new GCMParameterSpec(GCM_TAG_LENGTH_BITS, bytes,
+                KEY_VERSION_BLOB_LENGTH, GCM_IV_LENGTH));
+        cipher.updateAAD(bytes, 0, KEY_VERSION_BLOB_LENGTH);
+
+        return new String(cipher.doFinal(bytes, encryptedIndex, bytes.length - encryptedIndex),
+                AuthenticationConstants.ENCODING_UTF8);
     }
 
     /**
@@ -333,7 +504,7 @@ public class StorageHelper {
     private synchronized SecretKey getKeyOrCreate(final String keyVersion)
             throws GeneralSecurityException, IOException {
         if (VERSION_USER_DEFINED.equals(keyVersion)) {
-            return getSecretKey(AuthenticationSettings.INSTANCE.getSecretKeyData());
+            return getUserDefinedKey();
         }
 
         try {
@@ -365,7 +536,7 @@ public class StorageHelper {
     private synchronized SecretKey getKey(final String keyVersion) throws GeneralSecurityException, IOException {
         switch (keyVersion) {
         case VERSION_USER_DEFINED : 
-            return getSecretKey(AuthenticationSettings.INSTANCE.getSecretKeyData());
+            return getUserDefinedKey();
         case VERSION_ANDROID_KEY_STORE :
 
             if (mSecretKeyFromAndroidKeyStore != null) {
@@ -483,6 +654,20 @@ public class StorageHelper {
                 .build();
     }
 
+    /**
+     * The user provided key only changes when the app sets new key data, so the
+     * {@link SecretKeySpec} is rebuilt only when the raw bytes differ from the cached copy.
+     */
+    private synchronized SecretKey getUserDefinedKey() {
+        final byte[] secretKeyData = AuthenticationSettings.INSTANCE.getSecretKeyData();
+        if (mUserDefinedKey == null || !Arrays.equals(secretKeyData, mUserDefinedKeyData)) {
+            mUserDefinedKey = getSecretKey(secretKeyData);
+            mUserDefinedKeyData = secretKeyData.clone();
+        }
+
+        return mUserDefinedKey;
+    }
+
     private SecretKey getSecretKey(final byte[] rawBytes) {
         if (rawBytes == null) {
             throw new IllegalArgumentException("rawBytes");
@@ -499,14 +684,61 @@ public class StorageHelper {
      * @throws NoSuchAlgorithmException
      */
     private SecretKey getHMacKey(final SecretKey key) throws NoSuchAlgorithmException {
+        synchronized (mHMacKeys) {
+            final SecretKey cached = mHMacKeys.get(key);
+            if (cached != null) {
+                return cached;
+            }
+        }
+
         // Some keys may not produce byte[] with getEncoded
         final byte[] encodedKey = key.getEncoded();
+        SecretKey hmacKey = key;
         if (encodedKey != null) {
             final MessageDigest digester = MessageDigest.getInstance(HMAC_KEY_HASH_ALGORITHM);
-            return new SecretKeySpec(digester.digest(encodedKey), KEYSPEC_ALGORITHM);
+            hmacKey = new SecretKeySpec(digester.digest(encodedKey), KEYSPEC_ALGORITHM);
+        }
+
+        synchronized (mHMacKeys) {
+            // Data keys are only replaced when regenerated or when the app supplies new key
+            // data, drop stale derivations instead of letting them accumulate.
+            if (mHMacKeys.size() >= MAX_CACHED_HMAC_KEYS) {
+                mHMacKeys.clear();
+            }
+            mHMacKeys.put(key, hmacKey);
         }
- 
-        return key;
+
+        return hmacKey;
+    }
+
+    private static Cipher getCipher() throws GeneralSecurityException {
+        Cipher cipher = CIPHER.get();
+        if (cipher == null) {
+            cipher = Cipher.getInstance(CIPHER_ALGORITHM);
+            CIPHER.set(cipher);
+        }
+
+        return cipher;
+    }
+
+    private static Cipher getGcmCipher() throws GeneralSecurityException {
+        Cipher cipher = GCM_CIPHER.get();
+        if (cipher == null) {
+            cipher = Cipher.getInstance(GCM_CIPHER_ALGORITHM);
+            GCM_CIPHER.set(cipher);
+        }
+
+        return cipher;
+    }
+
+    private static Mac getMac() throws GeneralSecurityException {
+        Mac mac = MAC.get();
+        if (mac == null) {
+            mac = Mac.getInstance(HMAC_ALGORITHM);
+            MAC.set(mac);
+        }
+
+        return mac;
     }
 
     private char getEncodeVersionLengthPrefix() {
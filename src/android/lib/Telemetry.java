@@ -23,18 +23,95 @@
 
 package com.cordova.plugin.oidc;
 
-import android.util.Pair;
+import android.os.SystemClock;
 
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.Iterator;
 import java.util.Map;
 import java.util.UUID;
 import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicLong;
 
 public final class Telemetry {
     private static final String TAG = Telemetry.class.getSimpleName();
-    private DefaultDispatcher mDispatcher = null;
-    private final Map<Pair<String, String>, String> mEventTracking = new ConcurrentHashMap<Pair<String, String>, String>();
+
+    /**
+     * Name of the histogram of token cache lookup latency.
+     */
+    public static final String CACHE_LOOKUP_LATENCY = "cacheLookup";
+
+    /**
+     * Name of the histogram of HTTP round trip latency to the token endpoint.
+     */
+    public static final String HTTP_LATENCY = "http";
+
+    /**
+     * Name of the histogram of token grant latency, including retries and response parsing.
+     */
+    public static final String TOKEN_GRANT_LATENCY = "tokenGrant";
+
+    /**
+     * Name of the histogram of authority validation latency.
+     */
+    public static final String AUTHORITY_VALIDATION_LATENCY = "authorityValidation";
+
+    /**
+     * Name of the histogram of token cache SharedPreferences reads and writes, including encryption.
+     */
+    public static final String STORAGE_LATENCY = "storage";
+
+    /**
+     * Name of the histogram of end-to-end acquireTokenSilentAsync latency, up to the callback.
+     */
+    public static final String SILENT_REQUEST_LATENCY = "acquireTokenSilent";
+
+    /**
+     * Name of the counter of broker signature verifications that were not served from cache.
+     */
+    public static final String BROKER_SIGNATURE_CHECK_COUNT = "brokerSignatureChecks";
+
+    /**
+     * Name of the counter of broker user queries that were not served from cache.
+     */
+    public static final String BROKER_ACCOUNT_QUERY_COUNT = "brokerAccountQueries";
+
+    // Requests that are never flushed are swept once this many are tracked, and the oldest one
+    // is evicted if the sweep did not make room.
+    private static final int MAX_TRACKED_REQUESTS = 256;
+
+    private static final long TRACKED_REQUEST_IDLE_TIMEOUT_NANOS = TimeUnit.MINUTES.toNanos(10);
+
+    private volatile DefaultDispatcher mDispatcher = null;
+    private final ConcurrentHashMap<String, RequestEvents> mEventTracking = new ConcurrentHashMap<>();
+    private final Map<String, LatencyHistogram> mLatencyHistograms;
+    private final Map<String, LatencyHistogram> mEventLatencyHistograms = new HashMap<>();
+    private final Map<String, AtomicLong> mCounters;
     private static final Telemetry INSTANCE = new Telemetry();
 
+    private Telemetry() {
+        final Map<String, LatencyHistogram> histograms = new HashMap<>();
+        histograms.put(CACHE_LOOKUP_LATENCY, new LatencyHistogram());
+        histograms.put(HTTP_LATENCY, new LatencyHistogram());
+        histograms.put(TOKEN_GRANT_LATENCY, new LatencyHistogram());
+        histograms.put(AUTHORITY_VALIDATION_LATENCY, new LatencyHistogram());
+        histograms.put(STORAGE_LATENCY, new LatencyHistogram());
+        histograms.put(SILENT_REQUEST_LATENCY, new LatencyHistogram());
+        mLatencyHistograms = Collections.unmodifiableMap(histograms);
+
+        final Map<String, AtomicLong> counters = new HashMap<>();
+        counters.put(BROKER_SIGNATURE_CHECK_COUNT, new AtomicLong());
+        counters.put(BROKER_ACCOUNT_QUERY_COUNT, new AtomicLong());
+        mCounters = Collections.unmodifiableMap(counters);
+
+        mEventLatencyHistograms.put(EventStrings.TOKEN_CACHE_LOOKUP, histograms.get(CACHE_LOOKUP_LATENCY));
+        mEventLatencyHistograms.put(EventStrings.HTTP_EVENT, histograms.get(HTTP_LATENCY));
+        mEventLatencyHistograms.put(EventStrings.AUTHORITY_VALIDATION_EVENT,
+                histograms.get(AUTHORITY_VALIDATION_LATENCY));
+    }
+
     /**
      * Method to get the singleton instance of the Telemetry object.
      * @return Telemetry object
@@ -61,50 +138,215 @@ public final class Telemetry {
         }
     }
 
+    /**
+     * Latency histograms collected in process, keyed by the *_LATENCY names declared on this class.
+     * They are recorded whether or not a dispatcher is registered.
+     *
+     * @return read only map of histogram name to histogram
+     */
+    public Map<String, LatencyHistogram> getLatencyHistograms() {
+        return mLatencyHistograms;
+    }
+
+    /**
+     * Counters collected in process, keyed by the *_COUNT names declared on this class. Dividing
+     * by the {@link #SILENT_REQUEST_LATENCY} sample count gives the cost per silent request.
+     *
+     * @return copy of the counter values
+     */
+    public Map<String, Long> getCounters() {
+        final Map<String, Long> counters = new HashMap<>(mCounters.size());
+        for (final Map.Entry<String, AtomicLong> entry : mCounters.entrySet()) {
+            counters.put(entry.getKey(), entry.getValue().get());
+        }
+
+        return counters;
+    }
+
     static String registerNewRequest() {
         return UUID.randomUUID().toString();
     }
 
-    void startEvent(final String requestId, final String eventName) {
-        // We do not need to log if we do not have a dispatcher.
-        if (mDispatcher == null) {
-            return;
+    /**
+     * Records a latency sample measured outside of the start/stop event pair.
+     * @param histogramName name of the histogram
+     * @param startNanos start of the measurement from {@link SystemClock#elapsedRealtimeNanos()}
+     */
+    void recordLatency(final String histogramName, final long startNanos) {
+        final LatencyHistogram histogram = mLatencyHistograms.get(histogramName);
+        if (histogram != null) {
+            histogram.recordNanos(SystemClock.elapsedRealtimeNanos() - startNanos);
         }
+    }
 
-        mEventTracking.put(new Pair<>(requestId, eventName), Long.toString(System.currentTimeMillis()));
+    void incrementCounter(final String counterName) {
+        final AtomicLong counter = mCounters.get(counterName);
+        if (counter != null) {
+            counter.incrementAndGet();
+        }
     }
 
-    void stopEvent(final String requestId, final IEvents events, final String eventName) {
-        // We do not need to log if we do not have a dispatcher.
-        if (mDispatcher == null) {
+    void startEvent(final String requestId, final String eventName) {
+        if (requestId == null || eventName == null) {
             return;
         }
 
-        final String startTime = mEventTracking.get(new Pair<>(requestId, eventName));
+        final long nowNanos = SystemClock.elapsedRealtimeNanos();
+        RequestEvents requestEvents = mEventTracking.get(requestId);
+        if (requestEvents == null) {
+            if (mEventTracking.size() >= MAX_TRACKED_REQUESTS) {
+                evictAbandonedRequests(nowNanos);
+            }
+
+            final RequestEvents newRequestEvents = new RequestEvents();
+            requestEvents = mEventTracking.putIfAbsent(requestId, newRequestEvents);
+            if (requestEvents == null) {
+                requestEvents = newRequestEvents;
+            }
+        }
+
+        requestEvents.start(eventName, nowNanos, System.currentTimeMillis());
+    }
+
+    void stopEvent(final String requestId, final IEvents events, final String eventName) {
+        final long stopNanos = SystemClock.elapsedRealtimeNanos();
+        final RequestEvents requestEvents = requestId == null ? null : mEventTracking.get(requestId);
+        final int slot = requestEvents == null ? -1 : requestEvents.stop(eventName, stopNanos);
 
-        // If we did not get anything back from the dictionary, most likely its a bug that stopEvent was called without
+        // If we did not find a slot, most likely its a bug that stopEvent was called without
         // a corresponding startEvent
-        if (StringExtensions.isNullOrBlank(startTime)) {
+        if (slot < 0) {
             Logger.w(TAG, "Stop Event called without a corresponding start_event", "", null);
             return;
         }
 
-        long startTimeLong = Long.parseLong(startTime);
-        long stopTimeLong  = System.currentTimeMillis();
-        long diffTime = stopTimeLong - startTimeLong;
+        final long durationNanos = requestEvents.getDurationNanos(slot);
+        final LatencyHistogram histogram = mEventLatencyHistograms.get(eventName);
+        if (histogram != null) {
+            histogram.recordNanos(durationNanos);
+        }
+
+        // We do not need to fill in the event if we do not have a dispatcher.
+        final DefaultDispatcher dispatcher = mDispatcher;
+        if (dispatcher == null) {
+            return;
+        }
 
-        final String stopTime = Long.toString(stopTimeLong);
+        final long startTimeMillis = requestEvents.getStartTimeMillis(slot);
+        final long diffTime = TimeUnit.NANOSECONDS.toMillis(durationNanos);
 
-        events.setProperty(EventStrings.START_TIME, startTime);
-        events.setProperty(EventStrings.STOP_TIME, stopTime);
+        events.setProperty(EventStrings.START_TIME, Long.toString(startTimeMillis));
+        events.setProperty(EventStrings.STOP_TIME, Long.toString(startTimeMillis + diffTime));
         events.setProperty(EventStrings.RESPONSE_TIME, Long.toString(diffTime));
 
-        mDispatcher.receive(requestId, events);
+        dispatcher.receive(requestId, events);
     }
 
     void flush(final String requestId) {
-        if (mDispatcher != null) {
-            mDispatcher.flush(requestId);
+        if (requestId != null) {
+            mEventTracking.remove(requestId);
+        }
+
+        final DefaultDispatcher dispatcher = mDispatcher;
+        if (dispatcher != null) {
+            dispatcher.flush(requestId);
+        }
+    }
+
+    private void evictAbandonedRequests(final long nowNanos) {
+        Map.Entry<String, RequestEvents> oldest = null;
+        final Iterator<Map.Entry<String, RequestEvents>> iterator = mEventTracking.entrySet().iterator();
+        while (iterator.hasNext()) {
+            final Map.Entry<String, RequestEvents> entry = iterator.next();
+            final long lastTouchedNanos = entry.getValue().getLastTouchedNanos();
+            if (nowNanos - lastTouchedNanos > TRACKED_REQUEST_IDLE_TIMEOUT_NANOS) {
+                iterator.remove();
+            } else if (oldest == null || lastTouchedNanos < oldest.getValue().getLastTouchedNanos()) {
+                oldest = entry;
+            }
+        }
+
+        // Nothing was idle long enough, so make room by dropping the least recently used request
+        if (oldest != null && mEventTracking.size() >= MAX_TRACKED_REQUESTS) {
+            mEventTracking.remove(oldest.getKey(), oldest.getValue());
+        }
+    }
+
+    /**
+     * Start times of the events of one request, kept in parallel primitive arrays.
+     * A request has a handful of events, so slots are found with a linear scan.
+     */
+    private static final class RequestEvents {
+        private static final int INITIAL_CAPACITY = 8;
+
+        private String[] mEventNames = new String[INITIAL_CAPACITY];
+        private long[] mStartNanos = new long[INITIAL_CAPACITY];
+        private long[] mStartTimeMillis = new long[INITIAL_CAPACITY];
+        private long[] mDurationNanos = new long[INITIAL_CAPACITY];
+        private boolean[] mRunning = new boolean[INITIAL_CAPACITY];
+        private int mSize;
+        private volatile long mLastTouchedNanos;
+
+        synchronized void start(final String eventName, final long startNanos, final long startTimeMillis) {
+            int slot = findSlot(eventName);
+            if (slot < 0) {
+                if (mSize == mEventNames.length) {
+                    grow();
+                }
+                slot = mSize++;
+                mEventNames[slot] = eventName;
+            }
+
+            mStartNanos[slot] = startNanos;
+            mStartTimeMillis[slot] = startTimeMillis;
+            mRunning[slot] = true;
+            mLastTouchedNanos = startNanos;
+        }
+
+        /**
+         * @return the slot of the stopped event, or -1 if it was not started
+         */
+        synchronized int stop(final String eventName, final long stopNanos) {
+            final int slot = findSlot(eventName);
+            if (slot < 0 || !mRunning[slot]) {
+                return -1;
+            }
+
+            mDurationNanos[slot] = stopNanos - mStartNanos[slot];
+            mRunning[slot] = false;
+            mLastTouchedNanos = stopNanos;
+            return slot;
+        }
+
+        synchronized long getDurationNanos(final int slot) {
+            return mDurationNanos[slot];
+        }
+
+        synchronized long getStartTimeMillis(final int slot) {
+            return mStartTimeMillis[slot];
+        }
+
+        long getLastTouchedNanos() {
+            return mLastTouchedNanos;
+        }
+
+        private int findSlot(final String eventName) {
+            for (int i = 0; i < mSize; i++) {
+                if (mEventNames[i].equals(eventName)) {
+                    return i;
+                }
+            }
+
+            return -1;
+        }
+
+        private void grow() {
+            final int capacity = mEventNames.length * 2;
+            mEventNames = Arrays.copyOf(mEventNames, capacity);
+            mStartNanos = Arrays.copyOf(mStartNanos, capacity);
+            mStartTimeMillis = Arrays.copyOf(mStartTimeMillis, capacity);
+            mDurationNanos = Arrays.copyOf(mDurationNanos, capacity);
+            mRunning = Arrays.copyOf(mRunning, capacity);
         }
     }
 }
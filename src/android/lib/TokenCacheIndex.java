@@ -0,0 +1,256 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+package com.cordova.plugin.oidc;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.Set;
+import java.util.TreeMap;
+
+import com.google.gson.Gson;
+import com.google.gson.JsonParseException;
+
+import android.content.SharedPreferences;
+import android.content.SharedPreferences.Editor;
+
+/**
+ * Secondary indexes over the cache keys of {@link DefaultTokenCacheStore}, so that
+ * {@link ITokenStoreQuery} lookups only decrypt the items they return.
+ * Each cache key maps to the user id, resource and expiry of its item. The mapping is
+ * persisted in its own SharedPreferences file next to the token cache. It holds no tokens.
+ */
+final class TokenCacheIndex {
+
+    private static final String TAG = "TokenCacheIndex";
+
+    private static final long NO_EXPIRY = Long.MAX_VALUE;
+
+    /**
+     * Persisted index record of a single cache entry.
+     */
+    static final class Entry {
+        private String mUserId;
+        private String mResource;
+        private long mExpiresOn = NO_EXPIRY;
+    }
+
+    private final SharedPreferences mIndexPrefs;
+
+    private final Gson mGson = new Gson();
+
+    private final Map<String, Entry> mEntries = new HashMap<>();
+
+    private final Map<String, Set<String>> mKeysByUser = new HashMap<>();
+
+    private final Map<String, Set<String>> mKeysByResource = new HashMap<>();
+
+    private final TreeMap<Long, Set<String>> mKeysByExpiry = new TreeMap<>();
+
+    /**
+     * Stored keys whose item could not be read, so reconciling doesn't decrypt them again.
+     * Not persisted, they are looked at once per process.
+     */
+    private final Set<String> mUnreadableKeys = new HashSet<>();
+
+    TokenCacheIndex(final SharedPreferences indexPrefs) {
+        mIndexPrefs = indexPrefs;
+
+        @SuppressWarnings("unchecked")
+        final Map<String, String> persisted = (Map<String, String>) mIndexPrefs.getAll();
+        for (Map.Entry<String, String> record : persisted.entrySet()) {
+            try {
+                final Entry entry = mGson.fromJson(record.getValue(), Entry.class);
+                if (entry != null) {
+                    addToIndexes(record.getKey(), entry);
+                }
+            } catch (final JsonParseException exception) {
+                Logger.w(TAG, "Dropping unreadable index record", "", OIDCError.DEVICE_FILE_CACHE_FORMAT_IS_WRONG);
+            }
+        }
+    }
+
+    /**
+     * Drops index entries for keys no longer in the store and returns the stored keys
+     * that are neither indexed nor known to be unreadable, e.g. items written before the
+     * index existed or by another app sharing the store.
+     */
+    synchronized List<String> reconcile(final Collection<String> storedKeys) {
+        final Set<String> stored = new HashSet<>(storedKeys);
+        for (String key : new ArrayList<>(mEntries.keySet())) {
+            if (!stored.remove(key)) {
+                remove(key);
+            }
+        }
+
+        mUnreadableKeys.retainAll(stored);
+        stored.removeAll(mUnreadableKeys);
+
+        return new ArrayList<>(stored);
+    }
+
+    /**
+     * @return Number of stored keys the index knows about, indexed or unreadable.
+     */
+    synchronized int getTrackedKeyCount() {
+        return mEntries.size() + mUnreadableKeys.size();
+    }
+
+    synchronized void markUnreadable(final String key) {
+        mUnreadableKeys.add(key);
+    }
+
+    synchronized void put(final String key, final TokenCacheItem item) {
+        removeFromIndexes(key);
+        mUnreadableKeys.remove(key);
+
+        final Entry entry = new Entry();
+        entry.mUserId = item.getUserInfo() != null ? item.getUserInfo().getUserId() : null;
+        entry.mResource = item.getResource();
+        entry.mExpiresOn = item.getExpiresOn() != null ? item.getExpiresOn().getTime() : NO_EXPIRY;
+        addToIndexes(key, entry);
+
+        final Editor editor = mIndexPrefs.edit();
+        editor.putString(key, mGson.toJson(entry));
+        editor.apply();
+    }
+
+    synchronized void remove(final String key) {
+        mUnreadableKeys.remove(key);
+        if (removeFromIndexes(key)) {
+            final Editor editor = mIndexPrefs.edit();
+            editor.remove(key);
+            editor.apply();
+        }
+    }
+
+    synchronized void clear() {
+        mUnreadableKeys.clear();
+        mEntries.clear();
+        mKeysByUser.clear();
+        mKeysByResource.clear();
+        mKeysByExpiry.clear();
+
+        final Editor editor = mIndexPrefs.edit();
+        editor.clear();
+        editor.apply();
+    }
+
+    synchronized Set<String> getUsers() {
+        final Set<String> users = new HashSet<>();
+        for (Entry entry : mEntries.values()) {
+            if (entry.mUserId != null) {
+                users.add(entry.mUserId);
+            }
+        }
+
+        return users;
+    }
+
+    synchronized List<String> getKeysForUser(final String userId) {
+        return copyOf(mKeysByUser.get(normalizeUser(userId)));
+    }
+
+    synchronized List<String> getKeysForResource(final String resource) {
+        return copyOf(mKeysByResource.get(resource));
+    }
+
+    /**
+     * @param time Expiry cut-off in milliseconds since epoch.
+     * @return Keys of items that have an expiry strictly before the given time.
+     */
+    synchronized List<String> getKeysExpiringBefore(final long time) {
+        final List<String> keys = new ArrayList<>();
+        for (Set<String> bucket : mKeysByExpiry.headMap(time, false).values()) {
+            keys.addAll(bucket);
+        }
+
+        return keys;
+    }
+
+    private void addToIndexes(final String key, final Entry entry) {
+        mEntries.put(key, entry);
+        if (entry.mUserId != null) {
+            bucket(mKeysByUser, normalizeUser(entry.mUserId)).add(key);
+        }
+        if (entry.mResource != null) {
+            bucket(mKeysByResource, entry.mResource).add(key);
+        }
+        if (entry.mExpiresOn != NO_EXPIRY) {
+            bucket(mKeysByExpiry, entry.mExpiresOn).add(key);
+        }
+    }
+
+    private boolean removeFromIndexes(final String key) {
+        final Entry entry = mEntries.remove(key);
+        if (entry == null) {
+            return false;
+        }
+
+        if (entry.mUserId != null) {
+            unbucket(mKeysByUser, normalizeUser(entry.mUserId), key);
+        }
+        if (entry.mResource != null) {
+            unbucket(mKeysByResource, entry.mResource, key);
+        }
+        if (entry.mExpiresOn != NO_EXPIRY) {
+            unbucket(mKeysByExpiry, entry.mExpiresOn, key);
+        }
+
+        return true;
+    }
+
+    private static <K> Set<String> bucket(final Map<K, Set<String>> index, final K value) {
+        Set<String> keys = index.get(value);
+        if (keys == null) {
+            keys = new HashSet<>();
+            index.put(value, keys);
+        }
+
+        return keys;
+    }
+
+    private static <K> void unbucket(final Map<K, Set<String>> index, final K value, final String key) {
+        final Set<String> keys = index.get(value);
+        if (keys != null) {
+            keys.remove(key);
+            if (keys.isEmpty()) {
+                index.remove(value);
+            }
+        }
+    }
+
+    private static List<String> copyOf(final Set<String> keys) {
+        return keys == null ? new ArrayList<String>() : new ArrayList<>(keys);
+    }
+
+    // User ids are matched case-insensitively, see DefaultTokenCacheStore#getTokensForUser.
+    private static String normalizeUser(final String userId) {
+        return userId == null ? null : userId.toLowerCase(Locale.US);
+    }
+}
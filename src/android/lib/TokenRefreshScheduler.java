@@ -0,0 +1,347 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+package com.cordova.plugin.oidc;
+
+import android.content.Context;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Date;
+import java.util.EnumSet;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+import java.util.Random;
+import java.util.concurrent.Executors;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * Opt-in scheduler that refreshes access tokens for registered (resource, clientId, userId)
+ * tuples ahead of their expiry, so that foreground silent requests are served from the cache.
+ * A refresh is scheduled a short random delay before the token enters the expiration buffer
+ * ({@link AuthenticationSettings#getExpirationBuffer()}), which is the earliest point a silent
+ * request redeems the refresh token instead of returning the cached access token.
+ * Failures that need the user to sign in again stop the refresh until the tuple is registered
+ * again. The scheduler thread only runs while there is a refresh scheduled.
+ */
+final class TokenRefreshScheduler {
+
+    private static final String TAG = "TokenRefreshScheduler";
+
+    /**
+     * Upper bound of the random lead taken off each refresh, so that many tokens with the
+     * same expiry don't all hit the token endpoint at once.
+     */
+    private static final long MAX_JITTER_MS = TimeUnit.SECONDS.toMillis(30);
+
+    private static final long OFFLINE_RETRY_MS = TimeUnit.MINUTES.toMillis(1);
+
+    private static final long FAILURE_RETRY_MS = TimeUnit.MINUTES.toMillis(5);
+
+    /**
+     * Errors that a later retry can recover from, anything else needs the user to sign in again.
+     */
+    private static final EnumSet<OIDCError> RETRYABLE_ERRORS = EnumSet.of(OIDCError.AUTH_FAILED_NO_TOKEN,
+            OIDCError.DEVICE_CONNECTION_IS_NOT_AVAILABLE, OIDCError.SERVER_ERROR, OIDCError.IO_EXCEPTION,
+            OIDCError.AUTH_FAILED_SERVER_ERROR);
+
+    static final String OUTCOME_PENDING = "pending";
+
+    static final String OUTCOME_SUCCEEDED = "succeeded";
+
+    static final String OUTCOME_FAILED = "failed";
+
+    static final String OUTCOME_OFFLINE = "offline";
+
+    /**
+     * Refresh state of a single registered tuple.
+     */
+    static final class Registration {
+        private final String mResource;
+        private final String mClientId;
+        private final String mUserId;
+
+        private ScheduledFuture<?> mFuture;
+        private long mNextRefreshAt;
+        private long mLastRefreshAt;
+        private long mExpiresOn;
+        private String mLastOutcome = OUTCOME_PENDING;
+        private String mLastError;
+        private int mSuccessCount;
+        private int mFailureCount;
+
+        Registration(final String resource, final String clientId, final String userId) {
+            mResource = resource;
+            mClientId = clientId;
+            mUserId = userId;
+        }
+
+        /**
+         * @return Copy of the refresh state that is safe to read without holding the lock.
+         */
+        private Registration snapshot() {
+            final Registration snapshot = new Registration(mResource, mClientId, mUserId);
+            snapshot.mNextRefreshAt = mNextRefreshAt;
+            snapshot.mLastRefreshAt = mLastRefreshAt;
+            snapshot.mExpiresOn = mExpiresOn;
+            snapshot.mLastOutcome = mLastOutcome;
+            snapshot.mLastError = mLastError;
+            snapshot.mSuccessCount = mSuccessCount;
+            snapshot.mFailureCount = mFailureCount;
+            return snapshot;
+        }
+
+        String getResource() {
+            return mResource;
+        }
+
+        String getClientId() {
+            return mClientId;
+        }
+
+        String getUserId() {
+            return mUserId;
+        }
+
+        long getNextRefreshAt() {
+            return mNextRefreshAt;
+        }
+
+        long getLastRefreshAt() {
+            return mLastRefreshAt;
+        }
+
+        long getExpiresOn() {
+            return mExpiresOn;
+        }
+
+        String getLastOutcome() {
+            return mLastOutcome;
+        }
+
+        String getLastError() {
+            return mLastError;
+        }
+
+        int getSuccessCount() {
+            return mSuccessCount;
+        }
+
+        int getFailureCount() {
+            return mFailureCount;
+        }
+    }
+
+    private final AuthenticationContext mAuthContext;
+
+    private final IConnectionService mConnectionService;
+
+    // Created on demand and shut down once nothing is scheduled, guarded by mRegistrations
+    private ScheduledExecutorService mScheduler;
+
+    private final Random mRandom = new Random();
+
+    private final Map<String, Registration> mRegistrations = new HashMap<>();
+
+    TokenRefreshScheduler(final Context appContext, final AuthenticationContext authContext) {
+        this(authContext, new DefaultConnectionService(appContext));
+    }
+
+    TokenRefreshScheduler(final AuthenticationContext authContext, final IConnectionService connectionService) {
+        mAuthContext = authContext;
+        mConnectionService = connectionService;
+    }
+
+    /**
+     * Starts refreshing the token for the tuple. The first run only reads the cache, unless the
+     * token is already about to expire, and schedules the next refresh from its expiry.
+     */
+    void register(final String resource, final String clientId, final String userId) {
+        final Registration registration = new Registration(resource, clientId, userId);
+        synchronized (mRegistrations) {
+            final Registration existing = mRegistrations.put(getKey(resource, clientId, userId), registration);
+            cancel(existing);
+            schedule(registration, 0);
+        }
+    }
+
+    void unregister(final String resource, final String clientId, final String userId) {
+        synchronized (mRegistrations) {
+            cancel(mRegistrations.remove(getKey(resource, clientId, userId)));
+            shutdownIfIdle();
+        }
+    }
+
+    void unregisterAll() {
+        synchronized (mRegistrations) {
+            for (final Registration registration : mRegistrations.values()) {
+                cancel(registration);
+            }
+            mRegistrations.clear();
+            shutdownIfIdle();
+        }
+    }
+
+    /**
+     * @return Snapshot of the registered tuples and their refresh state. The entries are copies
+     *         and don't change as refreshes complete.
+     */
+    List<Registration> getSchedule() {
+        synchronized (mRegistrations) {
+            final List<Registration> schedule = new ArrayList<>(mRegistrations.size());
+            for (final Registration registration : mRegistrations.values()) {
+                schedule.add(registration.snapshot());
+            }
+            return schedule;
+        }
+    }
+
+    /**
+     * Returns how long to wait before refreshing a token that expires at the given time.
+     * Package visible so the schedule can be computed against a fixed clock.
+     */
+    static long getRefreshDelay(final long expiresOn, final long now, final long expirationBufferMs,
+                                final long jitterMs) {
+        return Math.max(0, expiresOn - expirationBufferMs - jitterMs - now);
+    }
+
+    // Must be called while holding mRegistrations
+    private void schedule(final Registration registration, final long delayMs) {
+        if (mScheduler == null) {
+            mScheduler = Executors.newSingleThreadScheduledExecutor();
+        }
+
+        registration.mNextRefreshAt = System.currentTimeMillis() + delayMs;
+        registration.mFuture = mScheduler.schedule(new Runnable() {
+            @Override
+            public void run() {
+                refresh(registration);
+            }
+        }, delayMs, TimeUnit.MILLISECONDS);
+    }
+
+    // Must be called while holding mRegistrations
+    private static void cancel(final Registration registration) {
+        if (registration != null && registration.mFuture != null) {
+            registration.mFuture.cancel(false);
+        }
+    }
+
+    // Must be called while holding mRegistrations
+    private void shutdownIfIdle() {
+        if (mScheduler == null) {
+            return;
+        }
+
+        for (final Registration registration : mRegistrations.values()) {
+            if (registration.mFuture != null && !registration.mFuture.isDone()) {
+                return;
+            }
+        }
+
+        // Lets the thread exit, a later register() starts a new one
+        mScheduler.shutdown();
+        mScheduler = null;
+    }
+
+    private void refresh(final Registration registration) {
+        if (!mConnectionService.isConnectionAvailable()) {
+            Logger.v(TAG, "Device is offline, postponing token refresh.");
+            onRefreshCompleted(registration, OUTCOME_OFFLINE, null, OFFLINE_RETRY_MS);
+            return;
+        }
+
+        mAuthContext.acquireTokenSilentAsync(registration.mResource, registration.mClientId, registration.mUserId,
+                new AuthenticationCallback<AuthenticationResult>() {
+                    @Override
+                    public void onSuccess(final AuthenticationResult result) {
+                        final Date expiresOn = result.getExpiresOn();
+                        final long now = System.currentTimeMillis();
+                        final long delay = expiresOn == null ? FAILURE_RETRY_MS : getRefreshDelay(expiresOn.getTime(),
+                                now, TimeUnit.SECONDS.toMillis(AuthenticationSettings.INSTANCE.getExpirationBuffer()),
+                                (long) (mRandom.nextDouble() * MAX_JITTER_MS));
+                        synchronized (mRegistrations) {
+                            registration.mExpiresOn = expiresOn == null ? 0 : expiresOn.getTime();
+                        }
+                        onRefreshCompleted(registration, OUTCOME_SUCCEEDED, null, delay);
+                    }
+
+                    @Override
+                    public void onError(final Exception exception) {
+                        Logger.w(TAG, "Background token refresh failed.", exception.getMessage(),
+                                OIDCError.AUTH_FAILED_NO_TOKEN);
+                        onRefreshCompleted(registration, OUTCOME_FAILED, exception.getMessage(),
+                                isRetryable(exception) ? FAILURE_RETRY_MS : -1);
+                    }
+                });
+    }
+
+    private static boolean isRetryable(final Exception exception) {
+        if (exception instanceof AuthenticationException) {
+            return RETRYABLE_ERRORS.contains(((AuthenticationException) exception).getCode());
+        }
+
+        return exception instanceof IOException;
+    }
+
+    /**
+     * @param nextDelayMs Delay until the next refresh, or a negative value to stop refreshing.
+     */
+    private void onRefreshCompleted(final Registration registration, final String outcome, final String error,
+                                    final long nextDelayMs) {
+        synchronized (mRegistrations) {
+            registration.mLastRefreshAt = System.currentTimeMillis();
+            registration.mLastOutcome = outcome;
+            registration.mLastError = error;
+            if (OUTCOME_SUCCEEDED.equals(outcome)) {
+                registration.mSuccessCount++;
+            } else if (OUTCOME_FAILED.equals(outcome)) {
+                registration.mFailureCount++;
+            }
+
+            // Don't resurrect a registration that was removed while the refresh was in flight
+            if (mRegistrations.get(getKey(registration.mResource, registration.mClientId, registration.mUserId))
+                    != registration) {
+                return;
+            }
+
+            if (nextDelayMs >= 0) {
+                schedule(registration, nextDelayMs);
+            } else {
+                Logger.w(TAG, "Background token refresh needs user interaction, stopping it.", error,
+                        OIDCError.AUTH_REFRESH_FAILED_PROMPT_NOT_ALLOWED);
+                registration.mFuture = null;
+                registration.mNextRefreshAt = 0;
+                shutdownIfIdle();
+            }
+        }
+    }
+
+    private static String getKey(final String resource, final String clientId, final String userId) {
+        return (resource + "$" + clientId + "$" + (userId == null ? "" : userId)).toLowerCase(Locale.US);
+    }
+}
@@ -25,10 +25,16 @@ package com.cordova.plugin.oidc;
 
 import android.util.Pair;
 
-import java.util.List;
-import java.util.Map;
+import java.util.Arrays;
+import java.util.HashSet;
+import java.util.Set;
 
 final class UIEvent extends DefaultEvent {
+    private static final Set<String> AGGREGATED_PROPERTIES = new HashSet<>(Arrays.asList(
+            EventStrings.USER_CANCEL,
+            EventStrings.NTLM
+    ));
+
     UIEvent(final String eventName) {
         getEventList().add(Pair.create(EventStrings.EVENT_NAME, eventName));
     }
@@ -48,35 +54,12 @@ final class UIEvent extends DefaultEvent {
     /**
      * Each event chooses which of its members get picked on aggregation.
      * UI event adds an event count field
-     * @param dispatchMap the Map that is filled with the aggregated event properties
+     * @param aggregatedEvent the aggregated event properties of the request
      */
     @Override
-    public void processEvent(final Map<String, String> dispatchMap) {
-        final List<Pair<String, String>> eventList = getEventList();
-
-        // We are keeping track of the number of UI Events here, first time we insert the UI_EVENT_COUNT into the map
-        // next time onwards, we read the value of it and increment by one.
-        final String count = dispatchMap.get(EventStrings.UI_EVENT_COUNT);
-        if (count == null) {
-            dispatchMap.put(EventStrings.UI_EVENT_COUNT, "1");
-        } else {
-            dispatchMap.put(EventStrings.UI_EVENT_COUNT, Integer.toString(Integer.parseInt(count) + 1));
-        }
-
-        if (dispatchMap.containsKey(EventStrings.USER_CANCEL)) {
-            dispatchMap.put(EventStrings.USER_CANCEL, "");
-        }
-
-        if (dispatchMap.containsKey(EventStrings.NTLM)) {
-            dispatchMap.put(EventStrings.NTLM, "");
-        }
-
-        for (Pair<String, String> eventPair : eventList) {
-            final String name = eventPair.first;
-
-            if (name.equals(EventStrings.USER_CANCEL) || name.equals(EventStrings.NTLM)) {
-                dispatchMap.put(name, eventPair.second);
-            }
-        }
+    public void processEvent(final AggregatedEvent aggregatedEvent) {
+        aggregatedEvent.increment(EventStrings.UI_EVENT_COUNT);
+        aggregatedEvent.clearExisting(AGGREGATED_PROPERTIES);
+        aggregatedEvent.collect(getEventList(), AGGREGATED_PROPERTIES);
     }
 }
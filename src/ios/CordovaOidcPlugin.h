@@ -8,6 +8,7 @@
 #import <Cordova/CDVPlugin.h>
 
 #import "OIDCAuthenticationContext.h"
+#import "OIDCTokenRefreshScheduler.h"
 
 // Implements Apache Cordova plugin for Microsoft Azure OIDC
 @interface CordovaOidcPlugin : CDVPlugin
@@ -17,6 +18,14 @@
 - (void)acquireTokenAsync:(CDVInvokedUrlCommand *)command;
 - (void)acquireTokenSilentAsync:(CDVInvokedUrlCommand *)command;
 
+// Background token refresh methods
+- (void)registerTokenRefresh:(CDVInvokedUrlCommand *)command;
+- (void)unregisterTokenRefresh:(CDVInvokedUrlCommand *)command;
+- (void)getTokenRefreshSchedule:(CDVInvokedUrlCommand *)command;
+
+// Returns latency histograms collected in process
+- (void)getMetricsSnapshot:(CDVInvokedUrlCommand *)command;
+
 // TokenCache methods
 - (void)tokenCacheClear:(CDVInvokedUrlCommand *)command;
 - (void)tokenCacheReadItems:(CDVInvokedUrlCommand *)command;
@@ -27,6 +36,10 @@
                                          responseType:(NSString *)responseType
                                     validateAuthority:(BOOL)validate;
 
++ (OIDCTokenRefreshScheduler *)getOrCreateRefreshScheduler:(NSString *)authority
+                                               authContext:(OIDCAuthenticationContext *)authContext;
++ (OIDCTokenRefreshScheduler *)refreshSchedulerForAuthority:(NSString *)authority;
+
 - (void)setLogger:(CDVInvokedUrlCommand *)command;
 - (void)setLogLevel:(CDVInvokedUrlCommand *) command;
 @end
@@ -143,6 +143,107 @@
     }];
 }
 
+- (void)registerTokenRefresh:(CDVInvokedUrlCommand *)command
+{
+    [self.commandDelegate runInBackground:^{
+        @try
+        {
+            NSString *authority = ObjectOrNil([command.arguments objectAtIndex:0]);
+            BOOL validateAuthority = [[command.arguments objectAtIndex:1] boolValue];
+            NSString *resourceId = ObjectOrNil([command.arguments objectAtIndex:2]);
+            NSString *clientId = ObjectOrNil([command.arguments objectAtIndex:3]);
+            NSString *userId = ObjectOrNil([command.arguments objectAtIndex:4]);
+
+            NSString *tokenEndpoint = @"/connect/authorize";
+            NSString *responseType = @"code";
+
+            OIDCAuthenticationContext *authContext = [CordovaOidcPlugin getOrCreateAuthContext:authority
+                                                                                 tokenEndpoint:tokenEndpoint
+                                                                                  responseType:responseType
+                                                                             validateAuthority:validateAuthority];
+
+            // TODO iOS sdk requires user name instead of guid so we should map provided id to a known user name
+            userId = [CordovaOidcUtils mapUserIdToUserName:authContext
+                                                    userId:userId];
+
+            [[CordovaOidcPlugin getOrCreateRefreshScheduler:authority authContext:authContext]
+             registerResource:resourceId clientId:clientId userId:userId];
+
+            CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_OK];
+            [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+        }
+        @catch (OIDCAuthenticationError *error)
+        {
+            CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_ERROR
+                                                          messageAsDictionary:[CordovaOidcUtils OIDCAuthenticationErrorToDictionary:error]];
+            [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+        }
+    }];
+}
+
+- (void)unregisterTokenRefresh:(CDVInvokedUrlCommand *)command
+{
+    [self.commandDelegate runInBackground:^{
+        @try
+        {
+            NSString *authority = ObjectOrNil([command.arguments objectAtIndex:0]);
+            BOOL validateAuthority = [[command.arguments objectAtIndex:1] boolValue];
+            NSString *resourceId = ObjectOrNil([command.arguments objectAtIndex:2]);
+            NSString *clientId = ObjectOrNil([command.arguments objectAtIndex:3]);
+            NSString *userId = ObjectOrNil([command.arguments objectAtIndex:4]);
+
+            NSString *tokenEndpoint = @"/connect/authorize";
+            NSString *responseType = @"code";
+
+            OIDCAuthenticationContext *authContext = [CordovaOidcPlugin getOrCreateAuthContext:authority
+                                                                                 tokenEndpoint:tokenEndpoint
+                                                                                  responseType:responseType
+                                                                             validateAuthority:validateAuthority];
+
+            userId = [CordovaOidcUtils mapUserIdToUserName:authContext
+                                                    userId:userId];
+
+            [[CordovaOidcPlugin refreshSchedulerForAuthority:authority]
+             unregisterResource:resourceId clientId:clientId userId:userId];
+
+            CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_OK];
+            [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+        }
+        @catch (OIDCAuthenticationError *error)
+        {
+            CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_ERROR
+                                                          messageAsDictionary:[CordovaOidcUtils OIDCAuthenticationErrorToDictionary:error]];
+            [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+        }
+    }];
+}
+
+- (void)getTokenRefreshSchedule:(CDVInvokedUrlCommand *)command
+{
+    [self.commandDelegate runInBackground:^{
+        NSString *authority = ObjectOrNil([command.arguments objectAtIndex:0]);
+
+        NSMutableArray *items = [NSMutableArray new];
+        for (OIDCTokenRefreshRegistration *registration in [[CordovaOidcPlugin refreshSchedulerForAuthority:authority] schedule])
+        {
+            [items addObject:[CordovaOidcUtils OIDCTokenRefreshRegistrationToDictionary:registration]];
+        }
+
+        CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_OK
+                                                           messageAsArray:items];
+        [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+    }];
+}
+
+- (void)getMetricsSnapshot:(CDVInvokedUrlCommand *)command
+{
+    [self.commandDelegate runInBackground:^{
+        CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_OK
+                                                      messageAsDictionary:[OIDCLatencyHistogram snapshot]];
+        [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+    }];
+}
+
 - (void)tokenCacheClear:(CDVInvokedUrlCommand *)command
 {
     [self.commandDelegate runInBackground:^{
@@ -288,9 +389,34 @@
     }];
 }
 
+// Number of log items that triggers an immediate flush
+static const NSUInteger kLogBatchSize = 50;
+// Maximum time a log item waits before it's sent to JS
+static const int64_t kLogFlushIntervalMs = 250;
+
 - (void) setLogger:(CDVInvokedUrlCommand *)command
 {
    [self.commandDelegate runInBackground:^{
+       // Log items are sent to JS in batches so that verbose logging doesn't cost one bridge
+       // message per log line. All batch state is only touched on logQueue.
+       dispatch_queue_t logQueue = dispatch_queue_create("cordova.oidc.logger", DISPATCH_QUEUE_SERIAL);
+       NSMutableArray *pendingItems = [NSMutableArray new];
+       __block BOOL flushScheduled = NO;
+
+       void (^flush)(void) = ^{
+           flushScheduled = NO;
+           if (pendingItems.count == 0)
+           {
+               return;
+           }
+
+           CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_OK
+                                                              messageAsArray:[pendingItems copy]];
+           [pluginResult setKeepCallbackAsBool:YES];
+           [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+           [pendingItems removeAllObjects];
+       };
+
        [OIDCLogger setLogCallBack:^(OIDC_LOG_LEVEL logLevel, NSString *message, NSString *additionalInfo, NSInteger errorCode, NSDictionary *userInfo) {
            NSMutableDictionary *logItem = [[NSMutableDictionary alloc] init];
 
@@ -299,10 +425,19 @@
            [logItem setValue:additionalInfo forKey:@"additionalInfo"];
            [logItem setValue:[NSNumber numberWithInteger:errorCode] forKey:@"errorCode"];
 
-           CDVPluginResult *pluginResult = [CDVPluginResult resultWithStatus:CDVCommandStatus_OK
-                                              messageAsDictionary:logItem];
-           [pluginResult setKeepCallbackAsBool:YES];
-           [self.commandDelegate sendPluginResult:pluginResult callbackId:command.callbackId];
+           dispatch_async(logQueue, ^{
+               [pendingItems addObject:logItem];
+
+               if (pendingItems.count >= kLogBatchSize)
+               {
+                   flush();
+               }
+               else if (!flushScheduled)
+               {
+                   flushScheduled = YES;
+                   dispatch_after(dispatch_time(DISPATCH_TIME_NOW, kLogFlushIntervalMs * NSEC_PER_MSEC), logQueue, flush);
+               }
+           });
        }];
    }];
 }
@@ -360,6 +495,37 @@ static NSMutableDictionary *existingContexts = nil;
     return authContext;
 }
 
+static NSMutableDictionary *refreshSchedulers = nil;
+
++ (OIDCTokenRefreshScheduler *)getOrCreateRefreshScheduler:(NSString *)authority
+                                               authContext:(OIDCAuthenticationContext *)authContext
+{
+    @synchronized(self)
+    {
+        if (!refreshSchedulers)
+        {
+            refreshSchedulers = [NSMutableDictionary dictionaryWithCapacity:1];
+        }
+
+        OIDCTokenRefreshScheduler *scheduler = [refreshSchedulers objectForKey:authority];
+        if (!scheduler)
+        {
+            scheduler = [[OIDCTokenRefreshScheduler alloc] initWithContext:authContext];
+            [refreshSchedulers setObject:scheduler forKey:authority];
+        }
+
+        return scheduler;
+    }
+}
+
++ (OIDCTokenRefreshScheduler *)refreshSchedulerForAuthority:(NSString *)authority
+{
+    @synchronized(self)
+    {
+        return [refreshSchedulers objectForKey:authority];
+    }
+}
+
 static id ObjectOrNil(id object)
 {
     return [object isKindOfClass:[NSNull class]] ? nil : object;
@@ -22,6 +22,9 @@
 // Populates dictonary from OIDCTokenCacheStoreItem class instance.
 + (NSMutableDictionary *)OIDCTokenCacheStoreItemToDictionary:(OIDCTokenCacheItem *)obj;
 
+// Populates dictonary from OIDCTokenRefreshRegistration class instance.
++ (NSMutableDictionary *)OIDCTokenRefreshRegistrationToDictionary:(OIDCTokenRefreshRegistration *)obj;
+
 // Retrieves user name from Token Cache Store.
 + (NSString *)mapUserIdToUserName:(OIDCAuthenticationContext *)authContext
                            userId:(NSString *)userId;
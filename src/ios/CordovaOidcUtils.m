@@ -75,6 +75,40 @@
     return dict;
 }
 
++ (NSMutableDictionary *)OIDCTokenRefreshRegistrationToDictionary:(OIDCTokenRefreshRegistration *)obj
+{
+    NSMutableDictionary *dict = [NSMutableDictionary dictionaryWithCapacity:1];
+
+    [dict setObject:ObjectOrNull(obj.resource) forKey:@"resource"];
+    [dict setObject:ObjectOrNull(obj.clientId) forKey:@"clientId"];
+    [dict setObject:ObjectOrNull(obj.userId) forKey:@"userId"];
+    [dict setObject:DateToMillisecondsOrNull(obj.expiresOn) forKey:@"expiresOn"];
+    [dict setObject:DateToMillisecondsOrNull(obj.nextRefreshOn) forKey:@"nextRefreshOn"];
+    [dict setObject:DateToMillisecondsOrNull(obj.lastRefreshOn) forKey:@"lastRefreshOn"];
+    [dict setObject:stringForRefreshOutcome(obj.lastOutcome) forKey:@"lastOutcome"];
+    [dict setObject:ObjectOrNull(obj.lastError) forKey:@"lastError"];
+    [dict setObject:[NSNumber numberWithUnsignedInteger:obj.successCount] forKey:@"successCount"];
+    [dict setObject:[NSNumber numberWithUnsignedInteger:obj.failureCount] forKey:@"failureCount"];
+
+    return dict;
+}
+
+static NSString *stringForRefreshOutcome(OIDCTokenRefreshOutcome outcome)
+{
+    switch (outcome)
+    {
+        case OIDC_REFRESH_SUCCEEDED: return @"succeeded";
+        case OIDC_REFRESH_FAILED: return @"failed";
+        case OIDC_REFRESH_OFFLINE: return @"offline";
+        default: return @"pending";
+    }
+}
+
+static id DateToMillisecondsOrNull(NSDate *date)
+{
+    return date ? [NSNumber numberWithDouble:[date timeIntervalSince1970] * 1000] : [NSNull null];
+}
+
 static id ObjectOrNull(id object)
 {
     return object ?: [NSNull null];
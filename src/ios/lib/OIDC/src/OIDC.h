@@ -55,6 +55,8 @@ typedef void(^OIDCAuthenticationCallback)(OIDCAuthenticationResult* result);
 #import "OIDCErrorCodes.h"
 #import "OIDCLogger.h"
 #import "OIDCTokenCacheItem.h"
+#import "OIDCTokenRefreshScheduler.h"
+#import "OIDCLatencyHistogram.h"
 #import "OIDCUserIdentifier.h"
 #import "OIDCUserInformation.h"
 #import "OIDCWebAuthController.h"
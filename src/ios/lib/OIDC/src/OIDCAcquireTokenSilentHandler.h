@@ -41,10 +41,24 @@
     OIDCAuthenticationResult* _mrrtResult;
     
     BOOL _attemptedFRT;
+    
+    // Set when the last refresh token redemption attached to a request already in flight
+    BOOL _coalescedRefresh;
 }
 
 + (OIDCAcquireTokenSilentHandler *)requestWithParams:(OIDCRequestParameters*)requestParams;
 
+/*!
+    Number of refresh token redemptions sent to the network by this process.
+ */
++ (NSUInteger)issuedRefreshCount;
+
+/*!
+    Number of refresh token redemptions that attached to an identical request
+    already in flight instead of going to the network.
+ */
++ (NSUInteger)coalescedRefreshCount;
+
 - (void)getToken:(OIDCAuthenticationCallback)completionBlock;
 
 @end
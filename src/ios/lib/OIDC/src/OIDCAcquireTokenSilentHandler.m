@@ -38,8 +38,38 @@
 #import "OIDCTelemetryEventStrings.h"
 #import "OIDCRequestParameters.h"
 
+// Refresh token redemptions currently on the wire, keyed by authority, client id, resource, user
+// and refresh token. Each entry holds the completion blocks waiting on that redemption.
+static NSMutableDictionary* s_inflightRefreshes = nil;
+static NSUInteger s_issuedRefreshCount = 0;
+static NSUInteger s_coalescedRefreshCount = 0;
+
 @implementation OIDCAcquireTokenSilentHandler
 
++ (void)initialize
+{
+    if (self == [OIDCAcquireTokenSilentHandler class])
+    {
+        s_inflightRefreshes = [NSMutableDictionary new];
+    }
+}
+
++ (NSUInteger)issuedRefreshCount
+{
+    @synchronized(s_inflightRefreshes)
+    {
+        return s_issuedRefreshCount;
+    }
+}
+
++ (NSUInteger)coalescedRefreshCount
+{
+    @synchronized(s_inflightRefreshes)
+    {
+        return s_coalescedRefreshCount;
+    }
+}
+
 + (OIDCAcquireTokenSilentHandler *)requestWithParams:(OIDCRequestParameters*)requestParams
 {
     OIDCAcquireTokenSilentHandler* handler = [OIDCAcquireTokenSilentHandler new];
@@ -88,6 +118,36 @@
                          cacheItem:(OIDCTokenCacheItem*)cacheItem
                    completionBlock:(OIDCAuthenticationCallback)completionBlock
 {
+    OIDCUserIdentifier* identifier = [_requestParams identifier];
+    NSString* inflightKey = [NSString stringWithFormat:@"%@|%@|%@|%@|%@",
+                             [_requestParams authority], [_requestParams clientId], [_requestParams resource],
+                             [identifier userId], refreshToken];
+    
+    // Every caller verifies the shared result against its own user
+    OIDCAuthenticationCallback waiter = ^(OIDCAuthenticationResult *result)
+    {
+        completionBlock([OIDCAuthenticationContext updateResult:result toUser:identifier]);
+    };
+    
+    @synchronized(s_inflightRefreshes)
+    {
+        NSMutableArray* waiters = [s_inflightRefreshes objectForKey:inflightKey];
+        if (waiters)
+        {
+            // An identical redemption is already on the wire, wait for its result instead of
+            // sending another refresh token grant and racing on the cache update.
+            [waiters addObject:[waiter copy]];
+            ++s_coalescedRefreshCount;
+            _coalescedRefresh = YES;
+            OIDC_LOG_INFO_F(@"Attaching to refresh token request already in flight", _requestParams.correlationId, @"clientId: '%@'; resource: '%@';", [_requestParams clientId], [_requestParams resource]);
+            return;
+        }
+        
+        [s_inflightRefreshes setObject:[NSMutableArray arrayWithObject:[waiter copy]] forKey:inflightKey];
+        ++s_issuedRefreshCount;
+        _coalescedRefresh = NO;
+    }
+    
     [OIDCLogger logToken:refreshToken
              tokenType:@"RT"
              expiresOn:nil
@@ -137,7 +197,8 @@
      {
          if (error)
          {
-             completionBlock([OIDCAuthenticationResult resultFromError:error]);
+             [OIDCAcquireTokenSilentHandler completeInflightRefresh:inflightKey
+                                                             result:[OIDCAuthenticationResult resultFromError:error]];
              [webReq invalidate];
              return;
          }
@@ -159,14 +220,29 @@
                                                  refreshToken:refreshToken
                                                       context:_requestParams];
          }
-         result = [OIDCAuthenticationContext updateResult:result toUser:[_requestParams identifier]];//Verify the user (just in case)
          
-         completionBlock(result);
+         [OIDCAcquireTokenSilentHandler completeInflightRefresh:inflightKey result:result];
          
          [webReq invalidate];
      }];
 }
 
++ (void)completeInflightRefresh:(NSString *)inflightKey
+                         result:(OIDCAuthenticationResult *)result
+{
+    NSArray* waiters = nil;
+    @synchronized(s_inflightRefreshes)
+    {
+        waiters = [s_inflightRefreshes objectForKey:inflightKey];
+        [s_inflightRefreshes removeObjectForKey:inflightKey];
+    }
+    
+    for (OIDCAuthenticationCallback waiter in waiters)
+    {
+        waiter(result);
+    }
+}
+
 - (NSString*)createAccessTokenRequestJWTUsingRT:(OIDCTokenCacheItem*)cacheItem
 {
     NSString* grantType = @"refresh_token";
@@ -212,6 +288,9 @@
                                                                         context:_requestParams];
          [event setGrantType:OIDC_TELEMETRY_VALUE_BY_REFRESH_TOKEN];
          [event setResultStatus:[result status]];
+         [event setIsCoalesced:_coalescedRefresh ? OIDC_TELEMETRY_VALUE_YES : OIDC_TELEMETRY_VALUE_NO];
+         [event setRefreshIssuedCount:[OIDCAcquireTokenSilentHandler issuedRefreshCount]
+                       coalescedCount:[OIDCAcquireTokenSilentHandler coalescedRefreshCount]];
          [[OIDCTelemetry sharedInstance] stopEvent:[_requestParams telemetryRequestId] event:event];
 
          NSString* resultStatus = @"Succeded";
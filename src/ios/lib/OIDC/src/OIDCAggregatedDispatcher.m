@@ -33,9 +33,24 @@
 #import "OIDCTelemetryBrokerEvent.h"
 #import "NSMutableDictionary+OIDCExtensions.h"
 
+// A property an event type contributes to the aggregated event, together with
+// its collection behavior, resolved once when the dispatcher class is loaded.
+@interface OIDCTelemetryAggregationRule : NSObject
+{
+@public
+    NSString *_propertyName;
+    OIDCTelemetryCollectionBehavior _behavior;
+}
+
+@end
+
+@implementation OIDCTelemetryAggregationRule
+@end
+
 @implementation OIDCAggregatedDispatcher
 
-static NSDictionary *s_eventPropertiesDictionary;
+// Event class -> NSArray<OIDCTelemetryAggregationRule *>
+static NSDictionary *s_eventAggregationRules;
 
 - (id)init
 {
@@ -58,9 +73,21 @@ static NSDictionary *s_eventPropertiesDictionary;
     [_dispatchLock unlock];
     
     NSMutableDictionary* aggregatedEvent = [NSMutableDictionary new];
+    if (eventsToBeDispatched.count > 0)
+    {
+        // Default parameters are identical for every event, add them once per request
+        [aggregatedEvent addEntriesFromDictionary:[OIDCTelemetryDefaultEvent defaultParameters]];
+    }
+    
+    NSMutableDictionary<NSString *, NSNumber *> *counters = [NSMutableDictionary new];
     for (id<OIDCTelemetryEventInterface> event in eventsToBeDispatched)
     {
-        [self addPropertiesToDictionary:aggregatedEvent event:event];
+        [self addPropertiesToDictionary:aggregatedEvent counters:counters event:event];
+    }
+    
+    for (NSString *propertyName in counters)
+    {
+        [aggregatedEvent setObject:[counters[propertyName] stringValue] forKey:propertyName];
     }
     
     [_dispatcher dispatchEvent:aggregatedEvent];
@@ -88,35 +115,35 @@ static NSDictionary *s_eventPropertiesDictionary;
     
 }
 
-- (void)addPropertiesToDictionary:(NSMutableDictionary*)aggregatedEvent event:(id<OIDCTelemetryEventInterface>)event
+- (void)addPropertiesToDictionary:(NSMutableDictionary*)aggregatedEvent
+                         counters:(NSMutableDictionary<NSString *, NSNumber *> *)counters
+                            event:(id<OIDCTelemetryEventInterface>)event
 {
-    [aggregatedEvent addEntriesFromDictionary:[OIDCTelemetryDefaultEvent defaultParameters]];
-    
-    NSString *eventClassName = NSStringFromClass([event class]);
+    NSArray<OIDCTelemetryAggregationRule *> *rules = [s_eventAggregationRules objectForKey:[event class]];
+    if (!rules)
+    {
+        return;
+    }
     
-    NSArray* eventProperties = [s_eventPropertiesDictionary objectForKey:eventClassName];
+    NSDictionary *properties = [event getProperties];
     
-    for (NSString* propertyName in eventProperties)
+    for (OIDCTelemetryAggregationRule *rule in rules)
     {
-        OIDCTelemetryCollectionBehavior collectionBehavior = [OIDCTelemetryCollectionRules getTelemetryCollectionRule:propertyName];
+        NSString *propertyName = rule->_propertyName;
         
-        if (collectionBehavior == CollectAndUpdate)
+        switch (rule->_behavior)
         {
-            //erase the previous event properties only if there were any previously
-            if ([aggregatedEvent objectForKey:propertyName])
-            {
+            case CollectAndCount:
+                counters[propertyName] = @([counters[propertyName] integerValue] + 1);
+                break;
+            case CollectAndUpdate:
+                //erase the previous event properties, only the latest event is reported
                 [aggregatedEvent removeObjectForKey:propertyName];
-            }
-        }
-        
-        if (collectionBehavior != CollectAndCount)
-        {
-            [aggregatedEvent adSetObjectIfNotNil:[[event getProperties] objectForKey:propertyName] forKey:propertyName];
-        }
-        else
-        {
-            int eventCount = [[aggregatedEvent objectForKey:propertyName] intValue];
-            [aggregatedEvent setObject:[NSString stringWithFormat:@"%d", ++eventCount] forKey:propertyName];
+                [aggregatedEvent adSetObjectIfNotNil:[properties objectForKey:propertyName] forKey:propertyName];
+                break;
+            default:
+                [aggregatedEvent adSetObjectIfNotNil:[properties objectForKey:propertyName] forKey:propertyName];
+                break;
         }
     }
 }
@@ -125,7 +152,7 @@ static NSDictionary *s_eventPropertiesDictionary;
 {
     if (self == [OIDCAggregatedDispatcher class])
     {
-        s_eventPropertiesDictionary = @{
+        NSDictionary *eventProperties = @{
                                       NSStringFromClass([OIDCTelemetryAPIEvent class]): @[
                                               // default properties apply to all events
                                               OIDC_TELEMETRY_KEY_REQUEST_ID,
@@ -190,6 +217,22 @@ static NSDictionary *s_eventPropertiesDictionary;
                                               OIDC_TELEMETRY_KEY_BROKER_VERSION
                                               ],
                                       };
+        
+        NSMutableDictionary *eventAggregationRules = [NSMutableDictionary new];
+        for (NSString *eventClassName in eventProperties)
+        {
+            NSMutableArray<OIDCTelemetryAggregationRule *> *rules = [NSMutableArray new];
+            for (NSString *propertyName in eventProperties[eventClassName])
+            {
+                OIDCTelemetryAggregationRule *rule = [OIDCTelemetryAggregationRule new];
+                rule->_propertyName = propertyName;
+                rule->_behavior = [OIDCTelemetryCollectionRules getTelemetryCollectionRule:propertyName];
+                [rules addObject:rule];
+            }
+            eventAggregationRules[(id<NSCopying>)NSClassFromString(eventClassName)] = rules;
+        }
+        
+        s_eventAggregationRules = eventAggregationRules;
     }
 }
 
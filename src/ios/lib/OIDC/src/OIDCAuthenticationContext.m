@@ -37,6 +37,7 @@
 #import "OIDCUserIdentifier.h"
 #import "OIDCTokenCacheItem.h"
 #import "OIDCAuthenticationRequest.h"
+#import "OIDCLatencyHistogram.h"
 
 typedef void(^OIDCAuthorizationCodeCallback)(NSString*, OIDCAuthenticationError*);
 
@@ -357,7 +358,12 @@ NSString* OIDC_VERSION_VAR = @OIDC_VERSION_STRING;
     REQUEST_WITH_REDIRECT_URL(redirectUri, clientId, resource);
     
     [request setSilent:YES];
-    [request acquireToken:@"7" completionBlock:completionBlock];
+    NSTimeInterval startUptime = [[NSProcessInfo processInfo] systemUptime];
+    [request acquireToken:@"7" completionBlock:^(OIDCAuthenticationResult *result)
+    {
+        [[OIDCLatencyHistogram histogramNamed:OIDC_METRICS_ACQUIRE_TOKEN_SILENT] recordSinceUptime:startUptime];
+        completionBlock(result);
+    }];
 }
 
 - (void)acquireTokenSilentWithResource:(NSString*)resource
@@ -371,7 +377,12 @@ NSString* OIDC_VERSION_VAR = @OIDC_VERSION_STRING;
     
     [request setUserId:userId];
     [request setSilent:YES];
-    [request acquireToken:@"8" completionBlock:completionBlock];
+    NSTimeInterval startUptime = [[NSProcessInfo processInfo] systemUptime];
+    [request acquireToken:@"8" completionBlock:^(OIDCAuthenticationResult *result)
+    {
+        [[OIDCLatencyHistogram histogramNamed:OIDC_METRICS_ACQUIRE_TOKEN_SILENT] recordSinceUptime:startUptime];
+        completionBlock(result);
+    }];
 }
 
 - (void)acquireTokenWithResource:(NSString*)resource
@@ -61,7 +61,8 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
     NSMutableDictionary *_validatedAdfsAuthorities;
     NSSet *_whitelistedOIDCHosts;
     
-    dispatch_queue_t _oidcValidationQueue;
+    // Completion blocks waiting on an in-flight OIDC validation, keyed by authority host
+    NSMutableDictionary<NSString *, NSMutableArray<OIDCAuthorityValidationCallback> *> *_pendingValidations;
 }
 
 
@@ -92,12 +93,12 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
                             s_kTrustedAuthorityChina, s_kTrustedAuthorityGermany,
                             s_kTrustedAuthorityWorldWide, s_kTrustedAuthorityUSGovernment, nil];
     
-    // A serial dispatch queue for all authority validation operations. A very common pattern is for
-    // applications to spawn a bunch of threads and call acquireToken on them right at the start. Many
-    // of those acquireToken calls will be to the same authority. To avoid making the exact same
-    // authority validation network call multiple times we throw the requests in this validation
-    // queue.
-    _oidcValidationQueue = dispatch_queue_create("oidc.validation.queue", DISPATCH_QUEUE_SERIAL);
+    // A very common pattern is for applications to spawn a bunch of threads and call acquireToken
+    // on them right at the start. Many of those acquireToken calls will be to the same authority.
+    // To avoid making the exact same authority validation network call multiple times, callers for
+    // a host that is already being validated wait on that request. Different hosts are validated
+    // in parallel.
+    _pendingValidations = [NSMutableDictionary new];
     
     return self;
 }
@@ -223,50 +224,49 @@ static NSString* const s_kWebFingerError               = @"WebFinger request was
         return;
     }
     
-    // If we wither didn't have a cache, or couldn't get the read lock (which only happens if someone
-    // has or is trying to get the write lock) then dispatch onto the OIDC validation queue.
-    dispatch_async(_oidcValidationQueue, ^{
-        
-        // If we didn't have anything in the cache then we need to hold onto the queue until we
-        // get a response back from the server, or timeout, or fail for any other reason
-        __block dispatch_semaphore_t dsem = dispatch_semaphore_create(0);
+    NSString *host = authority.adHostWithPortIfNecessary;
+    
+    @synchronized(_pendingValidations)
+    {
+        NSMutableArray<OIDCAuthorityValidationCallback> *waiters = _pendingValidations[host];
+        if (waiters)
+        {
+            OIDC_LOG_INFO(@"Waiting on in-flight Authority Validation", requestParams.correlationId, nil);
+            [waiters addObject:[completionBlock copy]];
+            return;
+        }
         
-        [self requestOIDCValidation:authority
-                     requestParams:requestParams
-                   completionBlock:^(BOOL validated, OIDCAuthenticationError *error)
+        _pendingValidations[host] = [NSMutableArray arrayWithObject:[completionBlock copy]];
+    }
+    
+    [self requestOIDCValidation:authority
+                  requestParams:requestParams
+                completionBlock:^(BOOL validated, OIDCAuthenticationError *error)
+     {
+         NSArray<OIDCAuthorityValidationCallback> *waiters = nil;
+         @synchronized(_pendingValidations)
+         {
+             waiters = _pendingValidations[host];
+             [_pendingValidations removeObjectForKey:host];
+         }
+         
+         // Jump off the network callback thread so slow completion blocks for one caller
+         // don't hold up the others.
+         for (OIDCAuthorityValidationCallback waiter in waiters)
          {
-             
-             // Because we're on a serialized queue here to ensure that we don't have more then one
-             // validation network request at a time, we want to jump off this queue as quick as
-             // possible whenever we hit an error to unblock the queue
-             
              dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-                 completionBlock(validated, error);
+                 waiter(validated, error);
              });
-             
-             dispatch_semaphore_signal(dsem);
-         }];
-        
-        // We're blocking the OIDC Validation queue here so that we only process one authority validation
-        // request at a time. As an application typically only uses a single OIDC authority, this cuts
-        // down on the amount of simultaneous requests that go out on multi threaded app launch
-        // scenarios.
-        if (dispatch_semaphore_wait(dsem, DISPATCH_TIME_NOW) != 0)
-        {
-            // Only bother logging if we have to wait on the queue.
-            OIDC_LOG_INFO(@"Waiting on Authority Validation Queue", requestParams.correlationId, nil);
-            dispatch_semaphore_wait(dsem, DISPATCH_TIME_FOREVER);
-            OIDC_LOG_INFO(@"Returned from Authority Validation Queue", requestParams.correlationId, nil);
-        }
-    });
+         }
+     }];
 }
 
 - (void)requestOIDCValidation:(NSURL *)authority
                requestParams:(OIDCRequestParameters *)requestParams
              completionBlock:(OIDCAuthorityValidationCallback)completionBlock
 {
-    // Before we make the request, check the cache again, as these requests happen on a serial queue
-    // and it's possible we were waiting on a request that got the information we're looking for.
+    // Before we make the request, check the cache again, as another validation for this host may
+    // have completed between the cache check and registering this request as in flight.
     OIDCAuthorityCacheRecord *record = [_oidcCache checkCache:authority];
     if (record)
     {
@@ -22,6 +22,9 @@
 // THE SOFTWARE.
 
 #import <Security/Security.h>
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h>
+#endif
 #import "OIDC_Internal.h"
 #import "OIDCKeychainTokenCache+Internal.h"
 #import "OIDCKeychainUtil.h"
@@ -32,6 +35,7 @@
 #import "OIDCWorkPlaceJoinUtil.h"
 #import "OIDCAuthenticationSettings.h"
 #import "OIDCTokenCacheItem+Internal.h"
+#import "OIDCLatencyHistogram.h"
 
 #define KEYCHAIN_VERSION 1
 #define STRINGIFY(x) #x
@@ -46,14 +50,43 @@ static NSString* const s_libraryString = @"MSOpenTech.OIDC." TOSTRING(KEYCHAIN_V
 static NSString* const s_keyForStoringTomestoneCleanTime = @"NextTombstoneCleanTime";
 static NSString* const s_tombstoneLibraryString = @"CordovaPlugin.OIDC.Tombstone." TOSTRING(KEYCHAIN_VERSION);
 
+// Darwin notification posted after every keychain write so other processes sharing the
+// keychain group drop their in-memory index. The shared group is appended to the name.
+static NSString* const s_cacheChangedNotificationPrefix = @"com.cordovaplugin.oidc.tokencachechanged.";
+
 static NSString* s_defaultKeychainGroup = @"com.cordovaplugin.oidccache";
 static OIDCKeychainTokenCache* s_defaultCache = nil;
 
+@interface OIDCKeychainTokenCache ()
+
+- (void)clearMemoryIndex;
+
+@end
+
+static void OIDCKeychainTokenCacheChanged(CFNotificationCenterRef center, void *observer, CFStringRef name, const void *object, CFDictionaryRef userInfo)
+{
+    (void)center;
+    (void)name;
+    (void)object;
+    (void)userInfo;
+    
+    // Darwin notifications are coalesced and carry no payload, so there is no reliable way to
+    // tell our own writes from another process' and the whole index is dropped either way.
+    [(__bridge OIDCKeychainTokenCache *)observer clearMemoryIndex];
+}
+
 @implementation OIDCKeychainTokenCache
 {
     NSString* _sharedGroup;
     NSDictionary* _default;
     NSDictionary* _defaultTombstone;
+    
+    // In-memory read-through index of decoded keychain items. Keyed by the keychain service
+    // string of the cache key (NSNull for wildcard queries), then by user id (NSNull for any user).
+    NSMutableDictionary* _memoryIndex;
+    // Bumped on every invalidation so a lookup racing with a write does not repopulate stale items
+    NSUInteger _memoryIndexGeneration;
+    NSString* _cacheChangedNotificationName;
 }
 
 + (OIDCKeychainTokenCache*)defaultKeychainCache
@@ -165,6 +198,23 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
     _default = defaultQuery;
     _defaultTombstone = defaultTombstoneQuery;
     
+    _memoryIndex = [NSMutableDictionary new];
+    _cacheChangedNotificationName = [s_cacheChangedNotificationPrefix stringByAppendingString:_sharedGroup ? _sharedGroup : sharedGroup];
+    CFNotificationCenterAddObserver(CFNotificationCenterGetDarwinNotifyCenter(),
+                                    (__bridge const void *)self,
+                                    OIDCKeychainTokenCacheChanged,
+                                    (__bridge CFStringRef)_cacheChangedNotificationName,
+                                    NULL,
+                                    CFNotificationSuspensionBehaviorDeliverImmediately);
+#if TARGET_OS_IPHONE
+    // Other apps in the keychain group may have written while we were suspended and
+    // Darwin notifications are not delivered to suspended processes.
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(clearMemoryIndex)
+                                                 name:UIApplicationWillEnterForegroundNotification
+                                               object:nil];
+#endif
+    
     static dispatch_once_t onceToken = 0;
     dispatch_once(&onceToken, ^{
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
@@ -175,11 +225,64 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
     return self;
 }
 
+- (void)dealloc
+{
+    CFNotificationCenterRemoveEveryObserver(CFNotificationCenterGetDarwinNotifyCenter(), (__bridge const void *)self);
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+}
+
 -  (NSString*)sharedGroup
 {
     return _sharedGroup;
 }
 
+#pragma mark -
+#pragma mark In-memory index
+
+- (void)clearMemoryIndex
+{
+    @synchronized(_memoryIndex)
+    {
+        [_memoryIndex removeAllObjects];
+        ++_memoryIndexGeneration;
+    }
+}
+
+// Drops the entries that a write to the given key could affect and tells other processes
+// sharing the keychain group to do the same. Must only be called once the keychain write
+// has landed, otherwise a concurrent lookup could re-index the old contents.
+- (void)invalidateMemoryIndexForKey:(OIDCTokenCacheKey *)key
+{
+    @synchronized(_memoryIndex)
+    {
+        if (key)
+        {
+            [_memoryIndex removeObjectForKey:[self keychainKeyFromCacheKey:key]];
+            [_memoryIndex removeObjectForKey:[NSNull null]];
+        }
+        else
+        {
+            [_memoryIndex removeAllObjects];
+        }
+        ++_memoryIndexGeneration;
+    }
+    
+    CFNotificationCenterPostNotification(CFNotificationCenterGetDarwinNotifyCenter(),
+                                         (__bridge CFStringRef)_cacheChangedNotificationName,
+                                         NULL, NULL, true);
+}
+
+// Items handed out are copies, callers are free to mutate them.
+static NSArray* copyItems(NSArray* items)
+{
+    NSMutableArray* copies = [[NSMutableArray alloc] initWithCapacity:items.count];
+    for (OIDCTokenCacheItem* item in items)
+    {
+        [copies addObject:[item copy]];
+    }
+    return copies;
+}
+
 #pragma mark -
 #pragma mark Keychain Loggig
 
@@ -267,7 +370,9 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
                                                             (id)kSecReturnData : @YES,
                                                             (id)kSecReturnAttributes : @YES}];
     CFTypeRef items = nil;
+    NSTimeInterval startUptime = [[NSProcessInfo processInfo] systemUptime];
     OSStatus status = SecItemCopyMatching((CFDictionaryRef)query, &items);
+    [[OIDCLatencyHistogram histogramNamed:OIDC_METRICS_KEYCHAIN] recordSinceUptime:startUptime];
     if (status == errSecItemNotFound)
     {
         return @[];
@@ -368,7 +473,12 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
     NSMutableDictionary* query = [self queryDictionaryForKey:key
                                                       userId:item.userInformation.userId
                                                   additional:nil];
-    return SecItemDelete((CFDictionaryRef)query);
+    OSStatus status = SecItemDelete((CFDictionaryRef)query);
+    if (status == errSecSuccess)
+    {
+        [self invalidateMemoryIndexForKey:key];
+    }
+    return status;
 }
 
 - (NSMutableArray *)filterOutTombstones:(NSArray *)items
@@ -612,6 +722,21 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
                                    correlationId:(NSUUID *)correlationId
                                            error:(OIDCAuthenticationError * __autoreleasing* )error
 {
+    id indexKey = key ? [self keychainKeyFromCacheKey:key] : [NSNull null];
+    id indexUser = userId ? userId : [NSNull null];
+    NSUInteger generation = 0;
+    
+    @synchronized(_memoryIndex)
+    {
+        NSArray* indexed = [[_memoryIndex objectForKey:indexKey] objectForKey:indexUser];
+        if (indexed)
+        {
+            [self logItemRetrievalStatus:indexed key:key userId:userId correlationId:correlationId];
+            return copyItems(indexed);
+        }
+        generation = _memoryIndexGeneration;
+    }
+    
     NSArray* items = [self keychainItemsWithKey:key userId:userId error:error];
     if (!items)
     {
@@ -631,6 +756,21 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
         [tokenItems addObject:item];
     }
     
+    @synchronized(_memoryIndex)
+    {
+        // Skip populating the index if a write landed while we were reading the keychain
+        if (generation == _memoryIndexGeneration)
+        {
+            NSMutableDictionary* userItems = [_memoryIndex objectForKey:indexKey];
+            if (!userItems)
+            {
+                userItems = [NSMutableDictionary new];
+                [_memoryIndex setObject:userItems forKey:indexKey];
+            }
+            [userItems setObject:copyItems(tokenItems) forKey:indexUser];
+        }
+    }
+    
     [self logItemRetrievalStatus:tokenItems key:key userId:userId correlationId:correlationId];
     return tokenItems;
     
@@ -724,9 +864,13 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
         }
         
         NSDictionary* attrToUpdate = @{ (id)kSecValueData : itemData };
+        OIDCLatencyHistogram *keychainHistogram = [OIDCLatencyHistogram histogramNamed:OIDC_METRICS_KEYCHAIN];
+        NSTimeInterval startUptime = [[NSProcessInfo processInfo] systemUptime];
         OSStatus status = SecItemUpdate((CFDictionaryRef)query, (CFDictionaryRef)attrToUpdate);
+        [keychainHistogram recordSinceUptime:startUptime];
         if (status == errSecSuccess)
         {
+            [self invalidateMemoryIndexForKey:key];
             return YES;
         }
         else if (status == errSecItemNotFound)
@@ -735,11 +879,14 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
             
             [query addEntriesFromDictionary:@{ (id)kSecValueData : itemData,
                                                (id)kSecAttrAccessible : (id)kSecAttrAccessibleAfterFirstUnlockThisDeviceOnly}];
+            startUptime = [[NSProcessInfo processInfo] systemUptime];
             status = SecItemAdd((CFDictionaryRef)query, NULL);
+            [keychainHistogram recordSinceUptime:startUptime];
             if ([OIDCKeychainTokenCache checkStatus:status operation:@"add" correlationId:correlationId error:error])
             {
                 return NO;
             }
+            [self invalidateMemoryIndexForKey:key];
         }
         else if ([OIDCKeychainTokenCache checkStatus:status operation:@"update" correlationId:correlationId error:error])
         {
@@ -757,6 +904,10 @@ static OIDCKeychainTokenCache* s_defaultCache = nil;
     {
         NSMutableDictionary* query = [self queryDictionaryForKey:nil userId:nil additional:nil];
         OSStatus status = SecItemDelete((CFDictionaryRef)query);
+        if (status == errSecSuccess)
+        {
+            [self invalidateMemoryIndexForKey:nil];
+        }
         [OIDCKeychainTokenCache checkStatus:status operation:@"remove all" correlationId:nil error:error];
         
         // Remove the tombstone timestamp as well;
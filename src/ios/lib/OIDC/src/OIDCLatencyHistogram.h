@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/*! Names of the latency histograms recorded by the library. */
+extern NSString *const OIDC_METRICS_CACHE_LOOKUP;
+extern NSString *const OIDC_METRICS_AUTHORITY_VALIDATION;
+extern NSString *const OIDC_METRICS_HTTP;
+extern NSString *const OIDC_METRICS_KEYCHAIN;
+extern NSString *const OIDC_METRICS_ACQUIRE_TOKEN_SILENT;
+
+/*! Names of the counters recorded by the library. */
+extern NSString *const OIDC_METRICS_WPJ_IDENTITY_LOOKUPS;
+
+/*!
+    In-process latency histogram with log-linear buckets, in the style of HdrHistogram.
+    Values are kept in microseconds with 16 sub-buckets per power of two, so reported
+    percentiles are within about 6% of the recorded values while memory stays fixed.
+ */
+@interface OIDCLatencyHistogram : NSObject
+
+/*! Returns the shared histogram with the given name, creating it on first use. */
++ (OIDCLatencyHistogram *)histogramNamed:(NSString *)name;
+
+/*!
+    Snapshot of all shared histograms, keyed by name. Each value is a dictionary with
+    "count" and the "p50", "p90", "p99" and "max" latencies in milliseconds. The shared
+    counters are reported under "counters", keyed by counter name.
+ */
++ (NSDictionary<NSString *, NSDictionary *> *)snapshot;
+
+/*! Increments the shared counter with the given name. */
++ (void)incrementCounter:(NSString *)name;
+
+/*! Records the time elapsed since startUptime, a value of [NSProcessInfo systemUptime]. */
+- (void)recordSinceUptime:(NSTimeInterval)startUptime;
+
+- (void)recordDuration:(NSTimeInterval)duration;
+
+@property (readonly) uint64_t count;
+@property (readonly) double maxMilliseconds;
+
+/*! Value in milliseconds at or below which the given percentage (0-100) of samples fall. */
+- (double)percentileMilliseconds:(double)percentile;
+
+@end
@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "OIDCLatencyHistogram.h"
+
+NSString *const OIDC_METRICS_CACHE_LOOKUP = @"cacheLookup";
+NSString *const OIDC_METRICS_AUTHORITY_VALIDATION = @"authorityValidation";
+NSString *const OIDC_METRICS_HTTP = @"http";
+NSString *const OIDC_METRICS_KEYCHAIN = @"keychain";
+NSString *const OIDC_METRICS_ACQUIRE_TOKEN_SILENT = @"acquireTokenSilent";
+
+NSString *const OIDC_METRICS_WPJ_IDENTITY_LOOKUPS = @"wpjIdentityLookups";
+
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+// Values are clamped to 2^36 microseconds, roughly 19 hours.
+#define MAX_VALUE_BITS 36
+#define BUCKET_COUNT ((MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT)
+
+static const uint64_t s_maxValueMicros = (1ULL << MAX_VALUE_BITS) - 1;
+
+static NSUInteger BucketIndex(uint64_t micros)
+{
+    if (micros < SUB_BUCKET_COUNT)
+    {
+        return (NSUInteger)micros;
+    }
+    
+    int exponent = 63 - __builtin_clzll(micros);
+    NSUInteger subBucket = (NSUInteger)(micros >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKET_COUNT - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+static uint64_t BucketUpperBound(NSUInteger index)
+{
+    if (index < SUB_BUCKET_COUNT)
+    {
+        return index;
+    }
+    
+    NSUInteger shift = index / SUB_BUCKET_COUNT - 1;
+    uint64_t lowerBound = (uint64_t)(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+    return lowerBound + (1ULL << shift) - 1;
+}
+
+@implementation OIDCLatencyHistogram
+{
+    uint64_t _counts[BUCKET_COUNT];
+    uint64_t _count;
+    uint64_t _maxMicros;
+}
+
+static NSMutableDictionary<NSString *, OIDCLatencyHistogram *> *s_histograms = nil;
+static NSMutableDictionary<NSString *, NSNumber *> *s_counters = nil;
+
++ (void)initialize
+{
+    if (self == [OIDCLatencyHistogram class])
+    {
+        s_histograms = [NSMutableDictionary new];
+        s_counters = [NSMutableDictionary dictionaryWithObject:@0 forKey:OIDC_METRICS_WPJ_IDENTITY_LOOKUPS];
+    }
+}
+
++ (void)incrementCounter:(NSString *)name
+{
+    @synchronized(s_counters)
+    {
+        s_counters[name] = @([s_counters[name] unsignedLongLongValue] + 1);
+    }
+}
+
++ (OIDCLatencyHistogram *)histogramNamed:(NSString *)name
+{
+    @synchronized(s_histograms)
+    {
+        OIDCLatencyHistogram *histogram = s_histograms[name];
+        if (!histogram)
+        {
+            histogram = [OIDCLatencyHistogram new];
+            s_histograms[name] = histogram;
+        }
+        return histogram;
+    }
+}
+
++ (NSDictionary<NSString *, NSDictionary *> *)snapshot
+{
+    NSDictionary<NSString *, OIDCLatencyHistogram *> *histograms = nil;
+    @synchronized(s_histograms)
+    {
+        histograms = [s_histograms copy];
+    }
+    
+    NSMutableDictionary *snapshot = [NSMutableDictionary dictionaryWithCapacity:histograms.count];
+    for (NSString *name in histograms)
+    {
+        OIDCLatencyHistogram *histogram = histograms[name];
+        snapshot[name] = @{ @"count" : @(histogram.count),
+                            @"p50" : @([histogram percentileMilliseconds:50]),
+                            @"p90" : @([histogram percentileMilliseconds:90]),
+                            @"p99" : @([histogram percentileMilliseconds:99]),
+                            @"max" : @(histogram.maxMilliseconds) };
+    }
+    
+    @synchronized(s_counters)
+    {
+        snapshot[@"counters"] = [s_counters copy];
+    }
+    
+    return snapshot;
+}
+
+- (void)recordSinceUptime:(NSTimeInterval)startUptime
+{
+    [self recordDuration:[[NSProcessInfo processInfo] systemUptime] - startUptime];
+}
+
+- (void)recordDuration:(NSTimeInterval)duration
+{
+    uint64_t micros = duration > 0 ? (uint64_t)(duration * USEC_PER_SEC) : 0;
+    micros = MIN(micros, s_maxValueMicros);
+    
+    @synchronized(self)
+    {
+        _counts[BucketIndex(micros)]++;
+        _count++;
+        _maxMicros = MAX(_maxMicros, micros);
+    }
+}
+
+- (uint64_t)count
+{
+    @synchronized(self)
+    {
+        return _count;
+    }
+}
+
+- (double)maxMilliseconds
+{
+    @synchronized(self)
+    {
+        return _maxMicros / 1000.0;
+    }
+}
+
+- (double)percentileMilliseconds:(double)percentile
+{
+    @synchronized(self)
+    {
+        if (_count == 0)
+        {
+            return 0;
+        }
+        
+        uint64_t target = MAX(1, (uint64_t)ceil(percentile / 100.0 * _count));
+        uint64_t cumulative = 0;
+        for (NSUInteger i = 0; i < BUCKET_COUNT; i++)
+        {
+            cumulative += _counts[i];
+            if (cumulative >= target)
+            {
+                return MIN(BucketUpperBound(i), _maxMicros) / 1000.0;
+            }
+        }
+        
+        return _maxMicros / 1000.0;
+    }
+}
+
+@end
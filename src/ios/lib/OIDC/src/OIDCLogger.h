@@ -81,5 +81,14 @@ typedef void (^LogCallback)(OIDC_LOG_LEVEL logLevel,
  */
 + (BOOL)getNSLogging;
 
+/*!
+    Log messages are handed off to a background queue before they are formatted and delivered,
+    so a slow log callback does not hold up authentication. If that queue backs up, new
+    messages are dropped instead of blocking the caller.
+ 
+    @return The number of log messages dropped since the process started.
+ */
++ (NSUInteger)droppedMessageCount;
+
 @end
 
@@ -28,6 +28,7 @@
 #include <sys/sysctl.h>
 #include <mach/machine.h>
 #include <CommonCrypto/CommonDigest.h>
+#include <stdatomic.h>
 
 @protocol LoggerContext <NSObject>
 
@@ -35,9 +36,17 @@
 
 @end
 
+// Upper bound on log messages waiting to be delivered, anything past this is dropped
+#define OIDC_LOG_QUEUE_CAPACITY 4096
+
 static OIDC_LOG_LEVEL s_LogLevel = OIDC_LOG_LEVEL_ERROR;
 static LogCallback s_LogCallback = nil;
+// Lets callers check for a callback without taking the lock guarding s_LogCallback
+static volatile BOOL s_HasLogCallback = NO;
 static BOOL s_NSLogging = YES;
+static dispatch_queue_t s_logQueue = nil;
+static atomic_uint s_pendingMessages = 0;
+static atomic_uint s_droppedMessages = 0;
 static NSString* s_OSString = @"UnkOS";
 
 static NSMutableDictionary* s_oidcId = nil;
@@ -48,6 +57,16 @@ static dispatch_once_t s_logOnce;
 
 + (void)initialize
 {
+    // Subclasses would otherwise run this again and replace the queue
+    if (self != [OIDCLogger class])
+    {
+        return;
+    }
+    
+    // Single consumer for all log messages, formatting and delivery happen here and never on
+    // the logging thread.
+    s_logQueue = dispatch_queue_create("oidc.logger.queue", DISPATCH_QUEUE_SERIAL);
+    
 #if TARGET_OS_IPHONE
     UIDevice* device = [UIDevice currentDevice];
 
@@ -81,6 +100,7 @@ static dispatch_once_t s_logOnce;
     @synchronized(self)//Avoid changing to null while attempting to call it.
     {
         s_LogCallback = [callback copy];
+        s_HasLogCallback = (s_LogCallback != nil);
     }
 }
 
@@ -95,6 +115,11 @@ static dispatch_once_t s_logOnce;
     return s_NSLogging;
 }
 
++ (NSUInteger)droppedMessageCount
+{
+    return atomic_load(&s_droppedMessages);
+}
+
 @end
 
 @implementation OIDCLogger (Internal)
@@ -119,6 +144,11 @@ static dispatch_once_t s_logOnce;
     }
 }
 
++ (BOOL)shouldLog:(OIDC_LOG_LEVEL)logLevel
+{
+    return logLevel > OIDC_LOG_LEVEL_NO_LOG && logLevel <= s_LogLevel && (s_HasLogCallback || s_NSLogging);
+}
+
 + (void)log:(OIDC_LOG_LEVEL)logLevel
     context:(id)context
     message:(NSString*)message
@@ -127,64 +157,114 @@ static dispatch_once_t s_logOnce;
 correlationId:(NSUUID*)correlationId
    userInfo:(NSDictionary *)userInfo
 {
-    static NSDateFormatter* s_dateFormatter = nil;
-    static dispatch_once_t s_dateOnce;
-    
-    dispatch_once(&s_dateOnce, ^{
-        s_dateFormatter = [[NSDateFormatter alloc] init];
-        [s_dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"UTC"]];
-        [s_dateFormatter setDateFormat:@"yyyy-MM-dd HH:mm:ss"];
-    });
-    
     //Note that the logging should not throw, as logging is heavily used in error conditions.
     //Hence, the checks below would rather swallow the error instead of throwing and changing the
     //program logic.
-    if (logLevel <= OIDC_LOG_LEVEL_NO_LOG)
-        return;
     if (!message)
         return;
+    if (![self shouldLog:logLevel])
+        return;
     
+    // Reserve a slot in the log queue, if it's full drop the message rather than blocking the caller
+    if (atomic_fetch_add(&s_pendingMessages, 1) >= OIDC_LOG_QUEUE_CAPACITY)
+    {
+        atomic_fetch_sub(&s_pendingMessages, 1);
+        atomic_fetch_add(&s_droppedMessages, 1);
+        return;
+    }
     
-    @synchronized(self)//Guard against thread-unsafe callback and modification of sLogCallback after the check
+    // The context may not be safe to use from another thread, so resolve the component here
+    NSString* component = nil;
+    if ([context respondsToSelector:@selector(component)])
     {
-        if (!(logLevel <= s_LogLevel && (s_LogCallback || s_NSLogging)))
+        id compRet = [context component];
+        if ([compRet isKindOfClass:[NSString class]])
         {
-            return;
-        }
-        
-        NSString* component = @"";
-        if ([context respondsToSelector:@selector(component)])
-        {
-            id compRet = [context component];
-            if ([compRet isKindOfClass:[NSString class]])
-            {
-                component = [NSString stringWithFormat:@" [%@]", compRet];
-            }
-        }
-        
-        NSString* correlationIdStr = @"";
-        if (correlationId)
-        {
-            correlationIdStr = [NSString stringWithFormat:@" - %@", correlationId.UUIDString];
+            component = compRet;
         }
+    }
+    
+    // Callers may pass mutable strings and keep changing them after this returns
+    message = [message copy];
+    info = [info copy];
+    component = [component copy];
+    userInfo = [userInfo copy];
+    
+    NSDate* date = [NSDate date];
+    dispatch_async(s_logQueue, ^{
+        [self deliver:logLevel
+                 date:date
+            component:component
+              message:message
+            errorCode:errorCode
+                 info:info
+        correlationId:correlationId
+             userInfo:userInfo];
+        atomic_fetch_sub(&s_pendingMessages, 1);
+    });
+}
+
+// Only called on s_logQueue
++ (void)deliver:(OIDC_LOG_LEVEL)logLevel
+           date:(NSDate*)date
+      component:(NSString*)component
+        message:(NSString*)message
+      errorCode:(NSInteger)errorCode
+           info:(NSString*)info
+  correlationId:(NSUUID*)correlationId
+       userInfo:(NSDictionary *)userInfo
+{
+    static NSDateFormatter* s_dateFormatter = nil;
+    static NSString* s_dateString = nil;
+    static time_t s_dateSecond = 0;
+    static unsigned int s_reportedDrops = 0;
+    
+    if (!s_dateFormatter)
+    {
+        s_dateFormatter = [[NSDateFormatter alloc] init];
+        [s_dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"UTC"]];
+        [s_dateFormatter setDateFormat:@"yyyy-MM-dd HH:mm:ss"];
+    }
+    
+    // The timestamp only has second resolution, so only format it once per second
+    time_t second = (time_t)[date timeIntervalSince1970];
+    if (!s_dateString || second != s_dateSecond)
+    {
+        s_dateString = [s_dateFormatter stringFromDate:date];
+        s_dateSecond = second;
+    }
+    
+    unsigned int drops = atomic_load(&s_droppedMessages);
+    if (drops != s_reportedDrops)
+    {
+        NSString* dropMessage = [NSString stringWithFormat:@"%u log messages dropped because the log queue was full", drops - s_reportedDrops];
+        s_reportedDrops = drops;
+        [self deliver:OIDC_LOG_LEVEL_WARN date:date component:nil message:dropMessage errorCode:0 info:nil correlationId:nil userInfo:nil];
+    }
+    
+    NSString* componentStr = component ? [NSString stringWithFormat:@" [%@]", component] : @"";
+    
+    NSString* correlationIdStr = @"";
+    if (correlationId)
+    {
+        correlationIdStr = [NSString stringWithFormat:@" - %@", correlationId.UUIDString];
+    }
+    
+    if (s_NSLogging)
+    {
+        NSString* levelString = [self stringForLevel:logLevel];
         
-        NSString* dateString =  [s_dateFormatter stringFromDate:[NSDate date]];
-        if (s_NSLogging)
-        {
-            NSString* levelString = [self stringForLevel:logLevel];
-            
-            NSString* msg = [NSString stringWithFormat:@"OIDC " OIDC_VERSION_STRING " %@ [%@%@]%@ %@: %@", s_OSString, dateString, correlationIdStr,
-                             component, levelString, message];
-            
-            //NSLog is documented as thread-safe:
-            NSLog(@"%@", msg);
-        }
+        NSString* msg = [NSString stringWithFormat:@"OIDC " OIDC_VERSION_STRING " %@ [%@%@]%@ %@: %@", s_OSString, s_dateString, correlationIdStr,
+                         componentStr, levelString, message];
         
-        if (s_LogCallback)
-        {
-            NSString* msg = [NSString stringWithFormat:@"OIDC " OIDC_VERSION_STRING " %@ [%@%@]%@ %@", s_OSString, dateString, correlationIdStr, component, message];
-            s_LogCallback(logLevel, msg, info, errorCode, userInfo);
-        }
+        NSLog(@"%@", msg);
+    }
+    
+    LogCallback callback = [self getLogCallBack];
+    if (callback)
+    {
+        NSString* msg = [NSString stringWithFormat:@"OIDC " OIDC_VERSION_STRING " %@ [%@%@]%@ %@", s_OSString, s_dateString, correlationIdStr, componentStr, message];
+        callback(logLevel, msg, info, errorCode, userInfo);
     }
 }
 
@@ -196,6 +276,12 @@ correlationId:(NSUUID*)correlationId
    userInfo:(NSDictionary *)userInfo
      format:(NSString *)format, ...
 {
+    // Don't pay for formatting messages that are going to be filtered out anyways
+    if (![self shouldLog:level])
+    {
+        return;
+    }
+    
     va_list args;
     va_start(args, format);
     NSString* info = [[NSString alloc] initWithFormat:format arguments:args];
@@ -42,4 +42,6 @@ typedef enum
 + (nonnull NSString*)computeThumbprint:(nonnull NSData*)data
                                 isSha2:(BOOL)isSha2;
 
++ (nullable NSString*)getOrgUnitFromIssuer:(nullable NSString*)issuer;
+
 @end
@@ -104,20 +104,23 @@
         NSString* certAuths = [challengeData valueForKey:@"CertAuthorities"];
         NSString* expectedThumbprint = [challengeData valueForKey:@"CertThumbprint"];
         
+        // A mismatch may mean the device was registered again since the identity was cached,
+        // so drop the cached identity and read it from the keychain on the next challenge.
         if (certAuths)
         {
-            NSString* issuerOU = [OIDCPkeyAuthHelper getOrgUnitFromIssuer:[info certificateIssuer]];
-            if (![self isValidIssuer:certAuths keychainCertIssuer:issuerOU])
+            if (![self isValidIssuer:certAuths keychainCertIssuer:[info certificateIssuerOU]])
             {
                 OIDC_LOG_ERROR(@"PKeyAuth Error: Certificate Authority specified by device auth request does not match certificate in keychain.", OIDC_ERROR_SERVER_WPJ_REQUIRED, nil, nil);
+                [OIDCWorkPlaceJoinUtil invalidateRegistrationInformation];
                 info = nil;
             }
         }
         else if (expectedThumbprint)
         {
-            if (![expectedThumbprint isEqualToString:[OIDCPkeyAuthHelper computeThumbprint:[info certificateData]]])
+            if (![expectedThumbprint isEqualToString:[info certificateThumbprint]])
             {
                 OIDC_LOG_ERROR(@"PKeyAuth Error: Certificate Thumbprint does not match certificate in keychain.", OIDC_ERROR_SERVER_WPJ_REQUIRED, nil, nil);
+                [OIDCWorkPlaceJoinUtil invalidateRegistrationInformation];
                 info = nil;
             }
         }
@@ -126,7 +129,13 @@
     NSString* pKeyAuthHeader = @"";
     if (info)
     {
-        pKeyAuthHeader = [NSString stringWithFormat:@"AuthToken=\"%@\",", [OIDCPkeyAuthHelper createDeviceAuthResponse:authorizationServer nonce:[challengeData valueForKey:@"nonce"] identity:info]];
+        NSString* deviceAuthResponse = [OIDCPkeyAuthHelper createDeviceAuthResponse:authorizationServer nonce:[challengeData valueForKey:@"nonce"] identity:info];
+        if (!deviceAuthResponse)
+        {
+            // Signing failed, the cached private key may no longer be usable
+            [OIDCWorkPlaceJoinUtil invalidateRegistrationInformation];
+        }
+        pKeyAuthHeader = [NSString stringWithFormat:@"AuthToken=\"%@\",", deviceAuthResponse];
         OIDC_LOG_INFO(@"Found WPJ Info and responded to PKeyAuth Request", context.correlationId, nil);
         info = nil;
     }
@@ -32,6 +32,8 @@
     NSString *_certificateIssuer;
     NSData *_certificateData;
     SecKeyRef _privateKey;
+    NSString *_certificateThumbprint;
+    NSString *_certificateIssuerOU;
 }
 
 @property (nonatomic, readonly) SecIdentityRef securityIdentity;
@@ -41,6 +43,11 @@
 @property (nonatomic, readonly) NSData *certificateData;
 @property (nonatomic, readonly) SecKeyRef privateKey;
 
+/*! SHA-1 thumbprint of the certificate data and OU of the issuer, computed once at init
+    so repeated PKeyAuth challenges don't recompute them. */
+@property (nonatomic, readonly) NSString *certificateThumbprint;
+@property (nonatomic, readonly) NSString *certificateIssuerOU;
+
 - (id)initWithSecurityIdentity:(SecIdentityRef)identity
              certificateIssuer:(NSString*)certificateIssuer
                    certificate:(SecCertificateRef)certificate
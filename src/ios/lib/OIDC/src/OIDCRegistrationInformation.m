@@ -22,6 +22,7 @@
 // THE SOFTWARE.
 
 #import "OIDCRegistrationInformation.h"
+#import "OIDCPkeyAuthHelper.h"
 
 @implementation OIDCRegistrationInformation
 
@@ -31,6 +32,8 @@
 @synthesize certificateData = _certificateData;
 @synthesize certificateIssuer = _certificateIssuer;
 @synthesize privateKey = _privateKey;
+@synthesize certificateThumbprint = _certificateThumbprint;
+@synthesize certificateIssuerOU = _certificateIssuerOU;
 
 - (id)initWithSecurityIdentity:(SecIdentityRef)identity
              certificateIssuer:(NSString*)certificateIssuer
@@ -58,6 +61,9 @@
     _certificateData = certificateData;
     _certificateIssuer = certificateIssuer;
     
+    _certificateThumbprint = [OIDCPkeyAuthHelper computeThumbprint:certificateData isSha2:NO];
+    _certificateIssuerOU = [OIDCPkeyAuthHelper getOrgUnitFromIssuer:certificateIssuer];
+    
     return self;
 }
 
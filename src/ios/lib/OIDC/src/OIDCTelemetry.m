@@ -28,13 +28,69 @@
 #import "OIDCAggregatedDispatcher.h"
 #import "OIDCTelemetryEventStrings.h"
 #import "NSString+OIDCHelperMethods.h"
+#import "OIDCLatencyHistogram.h"
 
-static NSString* const s_delimiter = @"|";
+// Pending events are tracked in shards keyed by request id so that concurrent
+// token requests do not contend on a single lock.
+#define OIDC_TELEMETRY_SHARD_COUNT 8
+
+// Requests that never reach flush: (e.g. abandoned by the caller) are evicted
+// once a shard grows past this many requests or they go idle for too long.
+static const NSUInteger s_maxTrackedRequestsPerShard = 64;
+static const NSTimeInterval s_trackedRequestIdleTimeout = 10 * 60;
+
+@interface OIDCTelemetryEventStart : NSObject
+
+@property (readonly) NSDate *startDate;
+@property (readonly) NSTimeInterval startUptime;
+
+@end
+
+@implementation OIDCTelemetryEventStart
+
+- (id)initWithDate:(NSDate *)startDate uptime:(NSTimeInterval)startUptime
+{
+    self = [super init];
+    if (self)
+    {
+        _startDate = startDate;
+        _startUptime = startUptime;
+    }
+    return self;
+}
+
+@end
+
+@interface OIDCTelemetryRequestTracking : NSObject
+{
+@public
+    NSMutableDictionary<NSString *, OIDCTelemetryEventStart *> *_events;
+    NSTimeInterval _lastTouched;
+}
+
+@end
+
+@implementation OIDCTelemetryRequestTracking
+
+- (id)init
+{
+    self = [super init];
+    if (self)
+    {
+        _events = [NSMutableDictionary new];
+    }
+    return self;
+}
+
+@end
 
 @interface OIDCTelemetry()
 {
-    NSMutableArray<OIDCDefaultDispatcher *> *_dispatchers;
-    NSMutableDictionary* _eventTracking;
+    NSArray<OIDCDefaultDispatcher *> *_dispatchers;
+    NSMutableDictionary<NSString *, OIDCTelemetryRequestTracking *> *_eventTracking[OIDC_TELEMETRY_SHARD_COUNT];
+    dispatch_queue_t _dispatchQueue;
+    // Event name -> histogram its duration is recorded into
+    NSDictionary<NSString *, OIDCLatencyHistogram *> *_eventHistograms;
 }
 
 @end
@@ -53,8 +109,15 @@ static NSString* const s_delimiter = @"|";
     self = [super init];
     if (self)
     {
-        _eventTracking = [NSMutableDictionary new];
-        _dispatchers = [NSMutableArray new];
+        for (NSUInteger i = 0; i < OIDC_TELEMETRY_SHARD_COUNT; i++)
+        {
+            _eventTracking[i] = [NSMutableDictionary new];
+        }
+        _dispatchers = @[];
+        _dispatchQueue = dispatch_queue_create("com.cordovaplugin.oidc.telemetry", DISPATCH_QUEUE_SERIAL);
+        _eventHistograms = @{ OIDC_TELEMETRY_EVENT_TOKEN_CACHE_LOOKUP : [OIDCLatencyHistogram histogramNamed:OIDC_METRICS_CACHE_LOOKUP],
+                              OIDC_TELEMETRY_EVENT_AUTHORITY_VALIDATION : [OIDCLatencyHistogram histogramNamed:OIDC_METRICS_AUTHORITY_VALIDATION],
+                              OIDC_TELEMETRY_EVENT_HTTP_REQUEST : [OIDCLatencyHistogram histogramNamed:OIDC_METRICS_HTTP] };
     }
     return self;
 }
@@ -74,16 +137,21 @@ static NSString* const s_delimiter = @"|";
 - (void)addDispatcher:(nonnull id<OIDCDispatcher>)dispatcher
        aggregationRequired:(BOOL)aggregationRequired
 {
+    OIDCDefaultDispatcher *adDispatcher = nil;
+    if (aggregationRequired)
+    {
+        adDispatcher = [[OIDCAggregatedDispatcher alloc] initWithDispatcher:dispatcher];
+    }
+    else
+    {
+        adDispatcher = [[OIDCDefaultDispatcher alloc] initWithDispatcher:dispatcher];
+    }
+    
+    // Dispatchers are copy-on-write so that the event path can take a snapshot
+    // without holding the lock while dispatching.
     @synchronized(self)
     {
-        if (aggregationRequired)
-        {
-            [_dispatchers addObject:[[OIDCAggregatedDispatcher alloc] initWithDispatcher:dispatcher]];
-        }
-        else
-        {
-            [_dispatchers addObject:[[OIDCDefaultDispatcher alloc] initWithDispatcher:dispatcher]];
-        }
+        _dispatchers = [_dispatchers arrayByAddingObject:adDispatcher];
     }
 }
 
@@ -91,13 +159,15 @@ static NSString* const s_delimiter = @"|";
 {
     @synchronized(self)
     {
+        NSMutableArray<OIDCDefaultDispatcher *> *dispatchers = [NSMutableArray arrayWithCapacity:_dispatchers.count];
         for(OIDCDefaultDispatcher *adDispatcher in _dispatchers)
         {
-            if ([adDispatcher containsDispatcher:dispatcher])
+            if (![adDispatcher containsDispatcher:dispatcher])
             {
-                [_dispatchers removeObject:adDispatcher];
+                [dispatchers addObject:adDispatcher];
             }
         }
+        _dispatchers = dispatchers;
     }
 }
 
@@ -105,7 +175,7 @@ static NSString* const s_delimiter = @"|";
 {
     @synchronized(self)
     {
-        [_dispatchers removeAllObjects];
+        _dispatchers = @[];
     }
 }
 
@@ -126,17 +196,33 @@ static NSString* const s_delimiter = @"|";
         return;
     }
     
-    NSDate* currentTime = [NSDate date];
-    @synchronized(self)
+    NSTimeInterval uptime = [[NSProcessInfo processInfo] systemUptime];
+    OIDCTelemetryEventStart *start = [[OIDCTelemetryEventStart alloc] initWithDate:[NSDate date] uptime:uptime];
+    
+    NSMutableDictionary<NSString *, OIDCTelemetryRequestTracking *> *shard = [self shardForRequestId:requestId];
+    @synchronized(shard)
     {
-        [_eventTracking setObject:currentTime
-                           forKey: [self getEventTrackingKey:requestId eventName:eventName]];
+        OIDCTelemetryRequestTracking *tracking = shard[requestId];
+        if (!tracking)
+        {
+            if (shard.count >= s_maxTrackedRequestsPerShard)
+            {
+                [self evictAbandonedRequests:shard now:uptime];
+            }
+            
+            tracking = [OIDCTelemetryRequestTracking new];
+            shard[requestId] = tracking;
+        }
+        
+        tracking->_events[eventName] = start;
+        tracking->_lastTouched = uptime;
     }
 }
 
 - (void)stopEvent:(NSString*)requestId
             event:(id<OIDCTelemetryEventInterface>)event
 {
+    NSTimeInterval stopUptime = [[NSProcessInfo processInfo] systemUptime];
     NSDate* stopTime = [NSDate date];
     NSString* eventName = [self getPropertyFromEvent:event propertyName:OIDC_TELEMETRY_KEY_EVENT_NAME];
     
@@ -145,50 +231,87 @@ static NSString* const s_delimiter = @"|";
         return;
     }
     
-    NSString* key = [self getEventTrackingKey:requestId eventName:eventName];
+    OIDCTelemetryEventStart *start = nil;
     
-    NSDate* startTime = nil;
-    
-    @synchronized(self)
+    NSMutableDictionary<NSString *, OIDCTelemetryRequestTracking *> *shard = [self shardForRequestId:requestId];
+    @synchronized(shard)
     {
-        startTime = [_eventTracking objectForKey:key];
-        if (!startTime)
+        OIDCTelemetryRequestTracking *tracking = shard[requestId];
+        start = tracking ? tracking->_events[eventName] : nil;
+        if (!start)
         {
             return;
         }
+        
+        [tracking->_events removeObjectForKey:eventName];
+        tracking->_lastTouched = stopUptime;
     }
     
-    [event setStartTime:startTime];
+    [event setStartTime:start.startDate];
     [event setStopTime:stopTime];
-    [event setResponseTime:[stopTime timeIntervalSinceDate:startTime]];
+    // Wall clock can jump while a request is in flight, so the duration comes
+    // from the monotonic uptime clock instead of the two dates.
+    [event setResponseTime:stopUptime - start.startUptime];
+    [_eventHistograms[eventName] recordDuration:stopUptime - start.startUptime];
     
-    @synchronized(self)
-    {
-        [_eventTracking removeObjectForKey:key];
-        
-        for (OIDCDefaultDispatcher *dispatcher in _dispatchers)
-        {
-            [dispatcher receive:requestId event:event];
-        }
-    }
+    [self dispatchEventNow:requestId event:event];
 }
 
 - (void)dispatchEventNow:(NSString*)requestId
                    event:(id<OIDCTelemetryEventInterface>)event
 {
-    @synchronized(self)
+    NSArray<OIDCDefaultDispatcher *> *dispatchers = [self dispatchersSnapshot];
+    if (dispatchers.count == 0)
     {
-        for (OIDCDefaultDispatcher *dispatcher in _dispatchers)
+        return;
+    }
+    
+    dispatch_async(_dispatchQueue, ^{
+        for (OIDCDefaultDispatcher *dispatcher in dispatchers)
         {
             [dispatcher receive:requestId event:event];
         }
+    });
+}
+
+- (NSArray<OIDCDefaultDispatcher *> *)dispatchersSnapshot
+{
+    @synchronized(self)
+    {
+        return _dispatchers;
     }
 }
 
-- (NSString*)getEventTrackingKey:(NSString*)requestId
-                       eventName:(NSString*)eventName
+- (NSMutableDictionary<NSString *, OIDCTelemetryRequestTracking *> *)shardForRequestId:(NSString *)requestId
 {
-    return [NSString stringWithFormat:@"%@%@%@", requestId, s_delimiter, eventName];
+    return _eventTracking[requestId.hash % OIDC_TELEMETRY_SHARD_COUNT];
+}
+
+// Must be called while holding the shard lock.
+- (void)evictAbandonedRequests:(NSMutableDictionary<NSString *, OIDCTelemetryRequestTracking *> *)shard
+                           now:(NSTimeInterval)now
+{
+    NSString *oldestRequestId = nil;
+    NSTimeInterval oldestTouched = now;
+    
+    for (NSString *requestId in shard.allKeys)
+    {
+        NSTimeInterval lastTouched = shard[requestId]->_lastTouched;
+        if (now - lastTouched > s_trackedRequestIdleTimeout)
+        {
+            [shard removeObjectForKey:requestId];
+        }
+        else if (lastTouched <= oldestTouched)
+        {
+            oldestTouched = lastTouched;
+            oldestRequestId = requestId;
+        }
+    }
+    
+    if (shard.count >= s_maxTrackedRequestsPerShard && oldestRequestId)
+    {
+        [shard removeObjectForKey:oldestRequestId];
+    }
 }
 
 - (NSString*)getPropertyFromEvent:(id<OIDCTelemetryEventInterface>)event
@@ -200,13 +323,30 @@ static NSString* const s_delimiter = @"|";
 
 - (void)flush:(NSString*)requestId
 {
-    @synchronized(self)
+    if (requestId)
     {
-        for (OIDCDefaultDispatcher *dispatcher in _dispatchers)
+        NSMutableDictionary<NSString *, OIDCTelemetryRequestTracking *> *shard = [self shardForRequestId:requestId];
+        @synchronized(shard)
         {
-            [dispatcher flush:requestId];
+            // Any event still open at this point was never stopped, drop it.
+            [shard removeObjectForKey:requestId];
         }
     }
+    
+    NSArray<OIDCDefaultDispatcher *> *dispatchers = [self dispatchersSnapshot];
+    if (dispatchers.count == 0)
+    {
+        return;
+    }
+    
+    // Runs on the same serial queue as receive:, so every event recorded for
+    // the request is delivered before the flush.
+    dispatch_async(_dispatchQueue, ^{
+        for (OIDCDefaultDispatcher *dispatcher in dispatchers)
+        {
+            [dispatcher flush:requestId];
+        }
+    });
 }
 
 @end
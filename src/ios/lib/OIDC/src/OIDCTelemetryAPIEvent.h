@@ -44,6 +44,8 @@
 - (void)setAuthority:(NSString *)authority;
 
 - (void)setGrantType:(NSString *)grantType;
+- (void)setIsCoalesced:(NSString *)isCoalesced;
+- (void)setRefreshIssuedCount:(NSUInteger)issuedCount coalescedCount:(NSUInteger)coalescedCount;
 - (void)setAPIStatus:(NSString *)status;
 
 - (void)setApiId:(NSString *)apiId;
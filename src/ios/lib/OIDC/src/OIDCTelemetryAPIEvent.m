@@ -136,6 +136,17 @@
     [self setProperty:OIDC_TELEMETRY_KEY_GRANT_TYPE value:grantType];
 }
 
+- (void)setIsCoalesced:(NSString *)isCoalesced
+{
+    [self setProperty:OIDC_TELEMETRY_KEY_IS_COALESCED value:isCoalesced];
+}
+
+- (void)setRefreshIssuedCount:(NSUInteger)issuedCount coalescedCount:(NSUInteger)coalescedCount
+{
+    [self setProperty:OIDC_TELEMETRY_KEY_REFRESH_ISSUED_COUNT value:[NSString stringWithFormat:@"%lu", (unsigned long)issuedCount]];
+    [self setProperty:OIDC_TELEMETRY_KEY_REFRESH_COALESCED_COUNT value:[NSString stringWithFormat:@"%lu", (unsigned long)coalescedCount]];
+}
+
 - (void)setAPIStatus:(NSString *)status
 {
     [self setProperty:OIDC_TELEMETRY_KEY_API_STATUS value:status];
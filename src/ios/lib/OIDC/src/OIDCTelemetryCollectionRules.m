@@ -94,6 +94,10 @@ static NSDictionary *_telemetryEventRules;
                              OIDC_TELEMETRY_KEY_SERVER_ERROR_CODE: @(CollectAndUpdate),
                              OIDC_TELEMETRY_KEY_SERVER_SUBERROR_CODE: @(CollectAndUpdate),
                              OIDC_TELEMETRY_KEY_RT_AGE: @(CollectAndUpdate),
+                             // Token grant
+                             OIDC_TELEMETRY_KEY_IS_COALESCED: @(CollectAndUpdate),
+                             OIDC_TELEMETRY_KEY_REFRESH_ISSUED_COUNT: @(CollectAndUpdate),
+                             OIDC_TELEMETRY_KEY_REFRESH_COALESCED_COUNT: @(CollectAndUpdate),
                              // UIEvent
                              OIDC_TELEMETRY_KEY_USER_CANCEL: @(CollectAndUpdate),
                              OIDC_TELEMETRY_KEY_NTLM_HANDLED: @(CollectAndUpdate)
@@ -93,6 +93,9 @@ extern NSString *const OIDC_TELEMETRY_KEY_HTTP_ERROR_DOMAIN;
 extern NSString *const OIDC_TELEMETRY_KEY_AUTHORITY;
 extern NSString *const OIDC_TELEMETRY_KEY_TOKEN_ENDPOINT;
 extern NSString *const OIDC_TELEMETRY_KEY_GRANT_TYPE;
+extern NSString *const OIDC_TELEMETRY_KEY_IS_COALESCED;
+extern NSString *const OIDC_TELEMETRY_KEY_REFRESH_ISSUED_COUNT;
+extern NSString *const OIDC_TELEMETRY_KEY_REFRESH_COALESCED_COUNT;
 extern NSString *const OIDC_TELEMETRY_KEY_API_STATUS;
 extern NSString *const OIDC_TELEMETRY_KEY_EVENT_NAME;
 extern NSString *const OIDC_TELEMETRY_KEY_REQUEST_ID;
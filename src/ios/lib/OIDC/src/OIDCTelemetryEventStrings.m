@@ -91,6 +91,9 @@ NSString *const OIDC_TELEMETRY_KEY_HTTP_ERROR_DOMAIN            = @"CordovaPlugi
 NSString *const OIDC_TELEMETRY_KEY_AUTHORITY                    = @"CordovaPlugin.OIDC.authority";
 NSString *const OIDC_TELEMETRY_KEY_TOKEN_ENDPOINT               = @"CordovaPlugin.OIDC.token_endpoint";
 NSString *const OIDC_TELEMETRY_KEY_GRANT_TYPE                   = @"CordovaPlugin.OIDC.grant_type";
+NSString *const OIDC_TELEMETRY_KEY_IS_COALESCED                 = @"CordovaPlugin.OIDC.is_coalesced";
+NSString *const OIDC_TELEMETRY_KEY_REFRESH_ISSUED_COUNT         = @"CordovaPlugin.OIDC.refresh_issued_count";
+NSString *const OIDC_TELEMETRY_KEY_REFRESH_COALESCED_COUNT      = @"CordovaPlugin.OIDC.refresh_coalesced_count";
 NSString *const OIDC_TELEMETRY_KEY_API_STATUS                   = @"CordovaPlugin.OIDC.api_status";
 NSString *const OIDC_TELEMETRY_KEY_REQUEST_ID                   = @"CordovaPlugin.OIDC.request_id";
 NSString *const OIDC_TELEMETRY_KEY_USER_CANCEL                  = @"CordovaPlugin.OIDC.user_cancel";
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class OIDCAuthenticationContext;
+
+/*! Outcome of the most recent background refresh of a registered token. */
+typedef enum
+{
+    OIDC_REFRESH_PENDING,
+    OIDC_REFRESH_SUCCEEDED,
+    OIDC_REFRESH_FAILED,
+    /*! The device was offline, the refresh is retried shortly. */
+    OIDC_REFRESH_OFFLINE,
+} OIDCTokenRefreshOutcome;
+
+/*! Refresh state of a single (resource, clientId, userId) registration. */
+@interface OIDCTokenRefreshRegistration : NSObject
+
+@property (readonly) NSString *resource;
+@property (readonly) NSString *clientId;
+@property (readonly) NSString *userId;
+
+@property (readonly) NSDate *expiresOn;
+@property (readonly) NSDate *nextRefreshOn;
+@property (readonly) NSDate *lastRefreshOn;
+@property (readonly) OIDCTokenRefreshOutcome lastOutcome;
+@property (readonly) NSString *lastError;
+@property (readonly) NSUInteger successCount;
+@property (readonly) NSUInteger failureCount;
+
+@end
+
+/*!
+    Opt-in scheduler that refreshes access tokens for registered (resource, clientId, userId)
+    tuples ahead of their expiry, so that foreground silent requests are served from the cache.
+    A refresh is scheduled a short random delay before the token enters the expiration buffer
+    (OIDCAuthenticationSettings expirationBuffer), which is the earliest point a silent request
+    redeems the refresh token instead of returning the cached access token.
+ */
+@interface OIDCTokenRefreshScheduler : NSObject
+
+- (id)initWithContext:(OIDCAuthenticationContext *)context;
+
+/*!
+    Starts refreshing the token for the tuple. The first run only reads the cache, unless the
+    token is already about to expire, and schedules the next refresh from its expiry.
+ */
+- (void)registerResource:(NSString *)resource
+                clientId:(NSString *)clientId
+                  userId:(NSString *)userId;
+
+- (void)unregisterResource:(NSString *)resource
+                  clientId:(NSString *)clientId
+                    userId:(NSString *)userId;
+
+- (void)unregisterAll;
+
+/*! Snapshot of the registered tuples and their refresh state. The entries are copies and don't change as refreshes complete. */
+- (NSArray<OIDCTokenRefreshRegistration *> *)schedule;
+
+/*! Returns how long to wait before refreshing a token expiring at the given date. */
++ (NSTimeInterval)refreshDelayForExpiresOn:(NSDate *)expiresOn
+                                       now:(NSDate *)now
+                          expirationBuffer:(NSTimeInterval)expirationBuffer
+                                    jitter:(NSTimeInterval)jitter;
+
+@end
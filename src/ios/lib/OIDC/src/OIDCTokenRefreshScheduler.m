@@ -0,0 +1,281 @@
+// Copyright (c) Microsoft Corporation.
+// All rights reserved.
+//
+// This code is licensed under the MIT License.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "OIDC_Internal.h"
+#import "OIDCTokenRefreshScheduler.h"
+#import "OIDCAuthenticationContext.h"
+#import "OIDCAuthenticationResult.h"
+#import "OIDCAuthenticationSettings.h"
+#import "OIDCTokenCacheItem.h"
+
+// Upper bound of the random lead taken off each refresh, so that many tokens with the same
+// expiry don't all hit the token endpoint at once.
+static const NSTimeInterval s_kMaxJitter = 30;
+static const NSTimeInterval s_kOfflineRetryDelay = 60;
+static const NSTimeInterval s_kFailureRetryDelay = 5 * 60;
+
+@interface OIDCTokenRefreshRegistration ()
+
+@property NSString *resource;
+@property NSString *clientId;
+@property NSString *userId;
+
+@property NSDate *expiresOn;
+@property NSDate *nextRefreshOn;
+@property NSDate *lastRefreshOn;
+@property OIDCTokenRefreshOutcome lastOutcome;
+@property NSString *lastError;
+@property NSUInteger successCount;
+@property NSUInteger failureCount;
+
+// Bumped whenever the registration is rescheduled or removed, so that stale timers do nothing
+@property NSUInteger generation;
+@property BOOL removed;
+
+@end
+
+@implementation OIDCTokenRefreshRegistration
+
+// Copy of the refresh state that is safe to read off the scheduler queue
+- (OIDCTokenRefreshRegistration *)snapshot
+{
+    OIDCTokenRefreshRegistration *snapshot = [OIDCTokenRefreshRegistration new];
+    snapshot.resource = _resource;
+    snapshot.clientId = _clientId;
+    snapshot.userId = _userId;
+    snapshot.expiresOn = _expiresOn;
+    snapshot.nextRefreshOn = _nextRefreshOn;
+    snapshot.lastRefreshOn = _lastRefreshOn;
+    snapshot.lastOutcome = _lastOutcome;
+    snapshot.lastError = _lastError;
+    snapshot.successCount = _successCount;
+    snapshot.failureCount = _failureCount;
+    return snapshot;
+}
+
+@end
+
+@implementation OIDCTokenRefreshScheduler
+{
+    OIDCAuthenticationContext *_context;
+    dispatch_queue_t _queue;
+    NSMutableDictionary<NSString *, OIDCTokenRefreshRegistration *> *_registrations;
+}
+
+- (id)initWithContext:(OIDCAuthenticationContext *)context
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    _context = context;
+    _queue = dispatch_queue_create("oidc.tokenrefresh.queue", DISPATCH_QUEUE_SERIAL);
+    _registrations = [NSMutableDictionary new];
+    
+    return self;
+}
+
+static NSString *RegistrationKey(NSString *resource, NSString *clientId, NSString *userId)
+{
+    return [[NSString stringWithFormat:@"%@|%@|%@", resource, clientId, userId ? userId : @""] lowercaseString];
+}
+
+- (void)registerResource:(NSString *)resource
+                clientId:(NSString *)clientId
+                  userId:(NSString *)userId
+{
+    OIDCTokenRefreshRegistration *registration = [OIDCTokenRefreshRegistration new];
+    registration.resource = resource;
+    registration.clientId = clientId;
+    registration.userId = userId;
+    registration.lastOutcome = OIDC_REFRESH_PENDING;
+    
+    dispatch_async(_queue, ^{
+        NSString *key = RegistrationKey(resource, clientId, userId);
+        _registrations[key].removed = YES;
+        _registrations[key] = registration;
+        [self schedule:registration afterDelay:0];
+    });
+}
+
+- (void)unregisterResource:(NSString *)resource
+                  clientId:(NSString *)clientId
+                    userId:(NSString *)userId
+{
+    dispatch_async(_queue, ^{
+        NSString *key = RegistrationKey(resource, clientId, userId);
+        _registrations[key].removed = YES;
+        [_registrations removeObjectForKey:key];
+    });
+}
+
+- (void)unregisterAll
+{
+    dispatch_async(_queue, ^{
+        for (OIDCTokenRefreshRegistration *registration in _registrations.allValues)
+        {
+            registration.removed = YES;
+        }
+        [_registrations removeAllObjects];
+    });
+}
+
+- (NSArray<OIDCTokenRefreshRegistration *> *)schedule
+{
+    NSMutableArray *schedule = [NSMutableArray new];
+    dispatch_sync(_queue, ^{
+        for (OIDCTokenRefreshRegistration *registration in _registrations.allValues)
+        {
+            [schedule addObject:[registration snapshot]];
+        }
+    });
+    return schedule;
+}
+
++ (NSTimeInterval)refreshDelayForExpiresOn:(NSDate *)expiresOn
+                                       now:(NSDate *)now
+                          expirationBuffer:(NSTimeInterval)expirationBuffer
+                                    jitter:(NSTimeInterval)jitter
+{
+    return MAX(0, [expiresOn timeIntervalSinceDate:now] - expirationBuffer - jitter);
+}
+
+#pragma mark - Scheduling
+
+// Must be called on _queue
+- (void)schedule:(OIDCTokenRefreshRegistration *)registration
+      afterDelay:(NSTimeInterval)delay
+{
+    NSUInteger generation = ++registration.generation;
+    registration.nextRefreshOn = [NSDate dateWithTimeIntervalSinceNow:delay];
+    
+    // Wall clock time so that the schedule still holds after the device wakes up from sleep
+    dispatch_after(dispatch_walltime(NULL, (int64_t)(delay * NSEC_PER_SEC)), _queue, ^{
+        if (registration.removed || registration.generation != generation)
+        {
+            return;
+        }
+        
+        [self refresh:registration];
+    });
+}
+
+- (void)refresh:(OIDCTokenRefreshRegistration *)registration
+{
+    [_context acquireTokenSilentWithResource:registration.resource
+                                    clientId:registration.clientId
+                                 redirectUri:nil
+                                      userId:registration.userId
+                             completionBlock:^(OIDCAuthenticationResult *result)
+     {
+         dispatch_async(_queue, ^{
+             [self completeRefresh:registration result:result];
+         });
+     }];
+}
+
+static BOOL RequiresUserInteraction(NSError *error)
+{
+    if (![error.domain isEqualToString:OIDCAuthenticationErrorDomain])
+    {
+        return NO;
+    }
+    
+    switch (error.code)
+    {
+        case OIDC_ERROR_SERVER_USER_INPUT_NEEDED:
+        case OIDC_ERROR_SERVER_REFRESH_TOKEN_REJECTED:
+        case OIDC_ERROR_SERVER_WRONG_USER:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+static BOOL IsOfflineError(NSError *error)
+{
+    if (![error.domain isEqualToString:NSURLErrorDomain])
+    {
+        return NO;
+    }
+    
+    switch (error.code)
+    {
+        case NSURLErrorNotConnectedToInternet:
+        case NSURLErrorNetworkConnectionLost:
+        case NSURLErrorDataNotAllowed:
+        case NSURLErrorInternationalRoamingOff:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+// Must be called on _queue
+- (void)completeRefresh:(OIDCTokenRefreshRegistration *)registration
+                 result:(OIDCAuthenticationResult *)result
+{
+    registration.lastRefreshOn = [NSDate date];
+    registration.lastError = result.error.errorDetails;
+    
+    NSTimeInterval delay = s_kFailureRetryDelay;
+    if (result.status == OIDC_SUCCEEDED && result.tokenCacheItem.expiresOn)
+    {
+        registration.lastOutcome = OIDC_REFRESH_SUCCEEDED;
+        registration.successCount++;
+        registration.expiresOn = result.tokenCacheItem.expiresOn;
+        
+        NSTimeInterval jitter = s_kMaxJitter * arc4random_uniform(1000) / 1000.0;
+        delay = [OIDCTokenRefreshScheduler refreshDelayForExpiresOn:registration.expiresOn
+                                                                now:registration.lastRefreshOn
+                                                   expirationBuffer:[[OIDCAuthenticationSettings sharedInstance] expirationBuffer]
+                                                             jitter:jitter];
+    }
+    else if (IsOfflineError(result.error))
+    {
+        OIDC_LOG_INFO(@"Device is offline, postponing token refresh.", nil, nil);
+        registration.lastOutcome = OIDC_REFRESH_OFFLINE;
+        delay = s_kOfflineRetryDelay;
+    }
+    else
+    {
+        OIDC_LOG_WARN(@"Background token refresh failed.", nil, result.error.errorDetails);
+        registration.lastOutcome = OIDC_REFRESH_FAILED;
+        registration.failureCount++;
+        
+        // Retrying won't help until the user signs in again and the tuple is registered again
+        if (RequiresUserInteraction(result.error))
+        {
+            registration.nextRefreshOn = nil;
+            return;
+        }
+    }
+    
+    if (!registration.removed)
+    {
+        [self schedule:registration afterDelay:delay];
+    }
+}
+
+@end
@@ -25,10 +25,26 @@
 
 @interface OIDCURLSessionDemux : NSObject
 
+/*!
+    Returns a process-wide demux for the scheme, host and port of the given URL.
+    All requests to the same authority share one NSURLSession so keep-alive and
+    HTTP/2 connections are reused across token and discovery calls.
+ */
++ (OIDCURLSessionDemux *)sharedDemuxForURL:(NSURL *)url;
+
 - (instancetype)initWithConfiguration:(NSURLSessionConfiguration *)configuration delegateQueue:(NSOperationQueue *)delegateQueue;
 
 - (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request delegate:(id<NSURLSessionDataDelegate>)delegate;
 
+/*!
+    Creates a data task routed to the given delegate. If onClientThread is NO the delegate
+    callbacks are delivered on a private serial queue owned by the task instead of the
+    calling thread, which is required for callers that don't run a run loop.
+ */
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                     delegate:(id<NSURLSessionDataDelegate>)delegate
+                       callbackOnClientThread:(BOOL)onClientThread;
+
 @property (atomic, copy,   readonly) NSURLSessionConfiguration* configuration;
 @property (atomic, strong, readonly) NSURLSession *session;
 
@@ -26,11 +26,14 @@
 
 @interface OIDCURLSessionDemuxTaskInfo : NSObject
 
-- (instancetype)initWithTask:(NSURLSessionDataTask *)task delegate:(id<NSURLSessionDataDelegate>)delegate;
+- (instancetype)initWithTask:(NSURLSessionDataTask *)task
+                    delegate:(id<NSURLSessionDataDelegate>)delegate
+              onClientThread:(BOOL)onClientThread;
 
 @property (atomic, strong) NSURLSessionDataTask *task;
 @property (atomic, strong) id<NSURLSessionDataDelegate> delegate;
 @property (atomic, strong) NSThread *thread;
+@property (atomic, strong) dispatch_queue_t queue;
 
 - (void)performBlock:(dispatch_block_t)block;
 
@@ -40,20 +43,38 @@
 
 @implementation OIDCURLSessionDemuxTaskInfo
 
-- (instancetype)initWithTask:(NSURLSessionDataTask *)task delegate:(id<NSURLSessionDataDelegate>)delegate
+- (instancetype)initWithTask:(NSURLSessionDataTask *)task
+                    delegate:(id<NSURLSessionDataDelegate>)delegate
+              onClientThread:(BOOL)onClientThread
 {
     self = [super init];
     if (self != nil)
     {
         self->_task = task;
         self->_delegate = delegate;
-        self->_thread = [NSThread currentThread];
+        if (onClientThread)
+        {
+            self->_thread = [NSThread currentThread];
+        }
+        else
+        {
+            // Per-task serial queue keeps the callbacks of one task ordered while letting
+            // tasks that share the session complete in parallel.
+            self->_queue = dispatch_queue_create("com.microsoft.oidc.demuxtask", DISPATCH_QUEUE_SERIAL);
+        }
     }
     return self;
 }
 
 - (void)performBlock:(dispatch_block_t)block
 {
+    dispatch_queue_t queue = self.queue;
+    if (queue)
+    {
+        dispatch_async(queue, block);
+        return;
+    }
+    
     [self performSelector:@selector(performBlockOnClientThread:)
                  onThread:self.thread
                withObject:[block copy]
@@ -69,6 +90,7 @@
 {
     self.delegate = nil;
     self.thread = nil;
+    self.queue = nil;
 }
 
 @end
@@ -83,6 +105,29 @@
 
 static const void *s_taskKey = &s_taskKey;
 
++ (OIDCURLSessionDemux *)sharedDemuxForURL:(NSURL *)url
+{
+    static NSMutableDictionary *s_demuxPool = nil;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        s_demuxPool = [NSMutableDictionary new];
+    });
+    
+    NSString *key = [[NSString stringWithFormat:@"%@://%@:%@", url.scheme, url.host, url.port] lowercaseString];
+    
+    @synchronized(s_demuxPool)
+    {
+        OIDCURLSessionDemux *demux = s_demuxPool[key];
+        if (!demux)
+        {
+            NSURLSessionConfiguration *config = [NSURLSessionConfiguration defaultSessionConfiguration];
+            demux = [[OIDCURLSessionDemux alloc] initWithConfiguration:config delegateQueue:nil];
+            s_demuxPool[key] = demux;
+        }
+        return demux;
+    }
+}
+
 - (instancetype)initWithConfiguration:(NSURLSessionConfiguration *)configuration
                         delegateQueue:(NSOperationQueue *)delegateQueue
 {
@@ -97,13 +142,21 @@ static const void *s_taskKey = &s_taskKey;
 }
 
 - (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request delegate:(id<NSURLSessionDataDelegate>)delegate
+{
+    return [self dataTaskWithRequest:request delegate:delegate callbackOnClientThread:YES];
+}
+
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                     delegate:(id<NSURLSessionDataDelegate>)delegate
+                       callbackOnClientThread:(BOOL)onClientThread
 {
     NSURLSessionDataTask *task;
     OIDCURLSessionDemuxTaskInfo *taskInfo;
     
     task = [self.session dataTaskWithRequest:request];
     taskInfo = [[OIDCURLSessionDemuxTaskInfo alloc] initWithTask:task
-                                                      delegate:delegate];
+                                                        delegate:delegate
+                                                  onClientThread:onClientThread];
     
     objc_setAssociatedObject(task, s_taskKey, taskInfo, OBJC_ASSOCIATION_RETAIN);
     
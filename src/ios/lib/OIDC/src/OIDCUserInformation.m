@@ -39,13 +39,16 @@ NSString* const OIDC_ID_TOKEN_JWT_TYPE = @"JWT";
 NSString* const OIDC_ID_TOKEN_OBJECT_ID = @"oid";
 NSString* const OIDC_ID_TOKEN_GUEST_ID = @"altsecid";
 
+// Archives carrying this version store the user identifiers next to the raw id_token, so they can
+// be unarchived without parsing the id_token.
+static const NSInteger s_kArchiveVersion = 2;
+
 @implementation OIDCUserInformation
 
 @synthesize userId = _userId;
 @synthesize rawIdToken = _rawIdToken;
 @synthesize userIdDisplayable = _userIdDisplayable;
 @synthesize uniqueId = _uniqueId;
-@synthesize allClaims = _allClaims;
 
 - (id)init
 {
@@ -96,26 +99,9 @@ NSString* const OIDC_ID_TOKEN_GUEST_ID = @"altsecid";
                                                  correlationId:nil];
 }
 
-- (id)initWithIdToken:(NSString *)idToken
-                error:(OIDCAuthenticationError * __autoreleasing *)error
++ (NSDictionary *)claimsFromIdToken:(NSString *)idToken
+                             error:(OIDCAuthenticationError * __autoreleasing *)error
 {
-    if (!(self = [super init]))
-    {
-        return nil;
-    }
-    
-    if (!idToken)
-    {
-        return nil;
-    }
-
-    if ([NSString adIsStringNilOrBlank:idToken])
-    {
-        RETURN_ID_TOKEN_ERROR;
-    }
-    
-    _rawIdToken = idToken;
-    
     NSArray* parts = [idToken componentsSeparatedByCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"."]];
     if (parts.count < 1)
     {
@@ -124,13 +110,17 @@ NSString* const OIDC_ID_TOKEN_GUEST_ID = @"altsecid";
     
     NSMutableDictionary* allClaims = [NSMutableDictionary new];
     NSString* type = nil;
-    for (NSString* part in parts)
+    // Only the header and the claims are JSON, the signature that follows is binary.
+    NSUInteger jsonPartCount = MIN(parts.count, (NSUInteger)2);
+    for (NSUInteger i = 0; i < jsonPartCount; i++)
     {
-        NSString* decoded = [part adBase64UrlDecode];
-        if (![NSString adIsStringNilOrBlank:decoded])
+        NSString* part = parts[i];
+        // Deserialize straight from the decoded bytes instead of going through an NSString
+        NSData* decoded = [NSString adBase64UrlDecodeData:part];
+        if (decoded.length > 0)
         {
             NSError* jsonError  = nil;
-            id jsonObject = [NSJSONSerialization JSONObjectWithData:[decoded dataUsingEncoding:NSUTF8StringEncoding]
+            id jsonObject = [NSJSONSerialization JSONObjectWithData:decoded
                                                             options:0
                                                               error:&jsonError];
                 if (jsonError)
@@ -175,7 +165,34 @@ NSString* const OIDC_ID_TOKEN_GUEST_ID = @"altsecid";
         OIDC_LOG_WARN(@"The id_token type is missing.", nil, @"Assuming JWT type.");
     }
     
-    _allClaims = allClaims;
+    return allClaims;
+}
+
+- (id)initWithIdToken:(NSString *)idToken
+                error:(OIDCAuthenticationError * __autoreleasing *)error
+{
+    if (!(self = [super init]))
+    {
+        return nil;
+    }
+    
+    if (!idToken)
+    {
+        return nil;
+    }
+
+    if ([NSString adIsStringNilOrBlank:idToken])
+    {
+        RETURN_ID_TOKEN_ERROR;
+    }
+    
+    _rawIdToken = idToken;
+    
+    _allClaims = [OIDCUserInformation claimsFromIdToken:idToken error:error];
+    if (!_allClaims)
+    {
+        return nil;
+    }
     
     //Now attempt to extract an unique user id:
     if (![NSString adIsStringNilOrBlank:self.upn])
@@ -224,6 +241,20 @@ NSString* const OIDC_ID_TOKEN_GUEST_ID = @"altsecid";
     return self;
 }
 
+- (NSDictionary *)allClaims
+{
+    // Unarchived objects only decode the claims when they are first needed
+    @synchronized(self)
+    {
+        if (!_allClaims && _rawIdToken)
+        {
+            _allClaims = [OIDCUserInformation claimsFromIdToken:_rawIdToken error:nil];
+        }
+        
+        return _allClaims;
+    }
+}
+
 //Declares a propperty getter, which extracts the property from the claims dictionary
 #define ID_TOKEN_PROPERTY_GETTER(property, claimName) \
 -(NSString*) property \
@@ -253,9 +284,15 @@ ID_TOKEN_PROPERTY_GETTER(guestId, OIDC_ID_TOKEN_GUEST_ID);
 - (id)copyWithZone:(NSZone *)zone
 {
     //Deep copy. Note that the user may have passed NSMutableString objects, so all of the objects should be copied:
-    NSString* idtoken = [_rawIdToken copyWithZone:zone];
-    OIDCUserInformation* info = [[OIDCUserInformation allocWithZone:zone] initWithIdToken:idtoken
-                                                                                error:nil];
+    OIDCUserInformation* info = [[OIDCUserInformation allocWithZone:zone] initWithUserId:_userId];
+    info->_rawIdToken = [_rawIdToken copyWithZone:zone];
+    info->_userIdDisplayable = _userIdDisplayable;
+    info->_uniqueId = [_uniqueId copyWithZone:zone];
+    @synchronized(self)
+    {
+        // Claims are immutable once parsed, if they haven't been parsed yet the copy will do it lazily
+        info->_allClaims = _allClaims;
+    }
     return info;
 }
 
@@ -293,14 +330,16 @@ ID_TOKEN_PROPERTY_GETTER(guestId, OIDC_ID_TOKEN_GUEST_ID);
 - (void)encodeWithCoder:(NSCoder *)aCoder
 {
     [aCoder encodeObject:_rawIdToken forKey:@"rawIdToken"];
+    [aCoder encodeInteger:s_kArchiveVersion forKey:@"version"];
+    [aCoder encodeObject:_userId forKey:@"userId"];
+    [aCoder encodeBool:_userIdDisplayable forKey:@"userIdDisplayable"];
+    [aCoder encodeObject:_uniqueId forKey:@"uniqueId"];
     
     // There was no official support for Mac in OIDC 1.x, so no need for this back compat code
     // which would greatly increase the size of the user information blobs.
 #if TARGET_OS_IPHONE
-    // These are needed for back-compat with OIDC 1.x
-    [aCoder encodeObject:_allClaims forKey:@"allClaims"];
-    [aCoder encodeObject:_userId forKey:@"userId"];
-    [aCoder encodeBool:_userIdDisplayable forKey:@"userIdDisplayable"];
+    // This is needed for back-compat with OIDC 1.x
+    [aCoder encodeObject:self.allClaims forKey:@"allClaims"];
 #endif
 }
 
@@ -308,8 +347,26 @@ ID_TOKEN_PROPERTY_GETTER(guestId, OIDC_ID_TOKEN_GUEST_ID);
 - (id)initWithCoder:(NSCoder *)aDecoder
 {
     NSString* idToken = [aDecoder decodeObjectOfClass:[NSString class] forKey:@"rawIdToken"];
+    NSString* userId = [aDecoder decodeObjectOfClass:[NSString class] forKey:@"userId"];
     
-    return [self initWithIdToken:idToken error:nil];
+    // Older archives only have the id_token to go off of, so they have to be parsed right away
+    if (!idToken || !userId || [aDecoder decodeIntegerForKey:@"version"] < s_kArchiveVersion)
+    {
+        return [self initWithIdToken:idToken error:nil];
+    }
+    
+    // Token cache lookups unarchive every matching item but rarely look at the claims, so
+    // defer decoding the id_token until allClaims is first accessed.
+    if (!(self = [self initWithUserId:userId]))
+    {
+        return nil;
+    }
+    
+    _rawIdToken = idToken;
+    _userIdDisplayable = [aDecoder decodeBoolForKey:@"userIdDisplayable"];
+    _uniqueId = [aDecoder decodeObjectOfClass:[NSString class] forKey:@"uniqueId"];
+    
+    return self;
 }
 
 @end
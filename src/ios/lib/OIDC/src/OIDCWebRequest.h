@@ -78,8 +78,8 @@ typedef void (^OIDCWebResponseCallback)(OIDCAuthenticationError *, NSMutableDict
 - (void)resend;
 
 /*!
-    Invalidates session object and nils the completionHandler.
-    Caller must invoke this method once it's done with the session.
+    Nils the completionHandler. The underlying session is pooled per authority and
+    is not torn down. Caller must invoke this method once it's done with the request.
     Do not use send or resend after calling invalidate.
  */
 - (void)invalidate;
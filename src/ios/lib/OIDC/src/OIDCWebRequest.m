@@ -34,6 +34,7 @@
 #import "OIDCTelemetryHttpEvent.h"
 #import "OIDCTelemetryEventStrings.h"
 #import "OIDCURLProtocol.h"
+#import "OIDCURLSessionDemux.h"
 #import "OIDCWebResponse.h"
 
 #import "NSURL+OIDCExtensions.h"
@@ -100,9 +101,6 @@
     
     _telemetryRequestId = context.telemetryRequestId;
     
-    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
-    _session = [NSURLSession sessionWithConfiguration:configuration delegate:self delegateQueue:nil];
-    
     return self;
 }
 
@@ -116,7 +114,10 @@
     _task           = nil;
     
     [self stopTelemetryEvent:error response:response];
-    _completionHandler(error, response);
+    if (_completionHandler)
+    {
+        _completionHandler(error, response);
+    }
 }
 
 - (void)send:(void (^)(NSError *, OIDCWebResponse *))completionHandler
@@ -168,13 +169,18 @@
     
     [OIDCURLProtocol addContext:self toRequest:request];
     
-    _task = [_session dataTaskWithRequest:request];
+    // Sessions are pooled per authority so repeated token and discovery calls reuse
+    // the existing connection instead of paying for a new TCP and TLS handshake.
+    OIDCURLSessionDemux *demux = [OIDCURLSessionDemux sharedDemuxForURL:requestURL];
+    _session = demux.session;
+    _task = [demux dataTaskWithRequest:request delegate:self callbackOnClientThread:NO];
     [_task resume];
 }
 
 - (void)invalidate
 {
-    [_session finishTasksAndInvalidate];
+    // The pooled session is shared with other requests, so only this request's
+    // state is released here. Any in-flight task is allowed to finish.
     _completionHandler = nil;
 }
 
@@ -29,7 +29,15 @@
 
 @interface OIDCWorkPlaceJoinUtil : NSObject
 
+/*!
+    Returns the Workplace Join identity. The result, including "not joined", is cached in memory
+    and read from the keychain again once it expires, when the app returns to the foreground, or
+    after +invalidateRegistrationInformation.
+ */
 + (OIDCRegistrationInformation*)getRegistrationInformation:(id<OIDCRequestContext>)context
                                                    error:(OIDCAuthenticationError * __autoreleasing *)error;
 
+/*! Drops the cached identity, e.g. after it failed to satisfy a PKeyAuth challenge. */
++ (void)invalidateRegistrationInformation;
+
 @end
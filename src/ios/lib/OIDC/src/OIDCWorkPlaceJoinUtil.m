@@ -21,6 +21,9 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h>
+#endif
 #import "OIDCWorkPlaceJoinUtil.h"
 #import "OIDCKeychainUtil.h"
 #import "OIDCRegistrationInformation.h"
@@ -28,9 +31,88 @@
 #import "OIDCLogger+Internal.h"
 #import "OIDCErrorCodes.h"
 #import "OIDC_Internal.h"
+#import "OIDCLatencyHistogram.h"
+
+// Another app can register or unregister the device while we're running, so cached results
+// are only trusted for a few minutes even without a foreground transition.
+#define OIDC_WPJ_CACHE_LIFETIME 300
+
+static OIDCRegistrationInformation* s_registrationInfo = nil;
+static BOOL s_registrationInfoCached = NO;
+static NSTimeInterval s_registrationInfoExpiresAt = 0;
+static NSUInteger s_registrationInfoGeneration = 0;
 
 @implementation OIDCWorkPlaceJoinUtil
 
++ (void)initialize
+{
+    if (self != [OIDCWorkPlaceJoinUtil class])
+    {
+        return;
+    }
+    
+#if TARGET_OS_IPHONE
+    // The registration is written by another app, which can only happen while we are in the
+    // background or not running.
+    [[NSNotificationCenter defaultCenter] addObserverForName:UIApplicationWillEnterForegroundNotification
+                                                      object:nil
+                                                       queue:nil
+                                                  usingBlock:^(NSNotification *note)
+    {
+        [OIDCWorkPlaceJoinUtil invalidateRegistrationInformation];
+    }];
+#endif
+}
+
++ (void)invalidateRegistrationInformation
+{
+    @synchronized(self)
+    {
+        s_registrationInfo = nil;
+        s_registrationInfoCached = NO;
+        s_registrationInfoGeneration++;
+    }
+}
+
++ (OIDCRegistrationInformation*)getRegistrationInformation:(id<OIDCRequestContext>)context
+                                                   error:(OIDCAuthenticationError * __autoreleasing *)error
+{
+    NSUInteger generation = 0;
+    @synchronized(self)
+    {
+        if (s_registrationInfoCached && [[NSProcessInfo processInfo] systemUptime] < s_registrationInfoExpiresAt)
+        {
+            return s_registrationInfo;
+        }
+        generation = s_registrationInfoGeneration;
+    }
+    
+    OIDCAuthenticationError* adError = nil;
+    OIDCRegistrationInformation* info = [self readRegistrationInformation:context error:&adError];
+    
+    @synchronized(self)
+    {
+        // Keychain failures are not cached, and neither is a result read across an invalidation
+        if (adError)
+        {
+            s_registrationInfo = nil;
+            s_registrationInfoCached = NO;
+        }
+        else if (generation == s_registrationInfoGeneration)
+        {
+            s_registrationInfo = info;
+            s_registrationInfoCached = YES;
+            s_registrationInfoExpiresAt = [[NSProcessInfo processInfo] systemUptime] + OIDC_WPJ_CACHE_LIFETIME;
+        }
+    }
+    
+    if (error && adError)
+    {
+        *error = adError;
+    }
+    return info;
+}
+
 // Convenience macro for checking keychain status codes while looking up the WPJ
 // information. We don't send errors for errSecItemNotFound (because not having
 // WPJ information is an expected case) or errSecNoAccessForItem (because non-
@@ -52,8 +134,8 @@
 }
 
 
-+ (OIDCRegistrationInformation*)getRegistrationInformation:(id<OIDCRequestContext>)context
-                                                   error:(OIDCAuthenticationError * __autoreleasing *)error
++ (OIDCRegistrationInformation*)readRegistrationInformation:(id<OIDCRequestContext>)context
+                                                    error:(OIDCAuthenticationError * __autoreleasing *)error
 {
     NSString* teamId = [OIDCKeychainUtil keychainTeamId:error];
 
@@ -100,6 +182,7 @@
     CFDictionaryRef result = NULL;
     OSStatus status = noErr;
     //get the issuer information
+    [OIDCLatencyHistogram incrementCounter:OIDC_METRICS_WPJ_IDENTITY_LOOKUPS];
     status = SecItemCopyMatching((__bridge CFDictionaryRef)identityAttr, (CFTypeRef *)&result);
     CHECK_KEYCHAIN_STATUS(@"retrieve wpj identity attr");
             
@@ -112,6 +195,7 @@
     
     // now get the identity out and use it.
     [identityAttr removeObjectForKey:(__bridge id<NSCopying>)(kSecReturnAttributes)];
+    [OIDCLatencyHistogram incrementCounter:OIDC_METRICS_WPJ_IDENTITY_LOOKUPS];
     status = SecItemCopyMatching((__bridge CFDictionaryRef)identityAttr, (CFTypeRef*)&identity);
     CHECK_KEYCHAIN_STATUS(@"retrieve wpj identity ref");;
     if (CFGetTypeID(identity) != SecIdentityGetTypeID())
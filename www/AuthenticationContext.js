@@ -120,4 +120,90 @@ AuthenticationContext.prototype.acquireTokenSilentAsync = function (resourceUrl,
     return d;
 };
 
+/**
+ * Registers a token to be refreshed in the background ahead of its expiry, so that later
+ * acquireTokenSilentAsync calls for the same resource, client and user are served from cache.
+ * Refreshes are skipped while the device is offline and retried once it is back online.
+ *
+ * @param   {String}  resourceUrl Resource identifier
+ * @param   {String}  clientId    Client (application) identifier
+ * @param   {String}  userId      User identifier (optional)
+ *
+ * @returns {Promise} Promise either fulfilled when the token is registered or rejected with error
+ */
+AuthenticationContext.prototype.registerTokenRefresh = function (resourceUrl, clientId, userId) {
+
+    checkArgs('ssS', 'AuthenticationContext.registerTokenRefresh', arguments);
+
+    return bridge.executeNativeMethod('registerTokenRefresh', [this.authority, this.validateAuthority, resourceUrl, clientId, userId]);
+};
+
+/**
+ * Stops refreshing a token previously registered with registerTokenRefresh.
+ *
+ * @param   {String}  resourceUrl Resource identifier
+ * @param   {String}  clientId    Client (application) identifier
+ * @param   {String}  userId      User identifier (optional)
+ *
+ * @returns {Promise} Promise either fulfilled when the token is unregistered or rejected with error
+ */
+AuthenticationContext.prototype.unregisterTokenRefresh = function (resourceUrl, clientId, userId) {
+
+    checkArgs('ssS', 'AuthenticationContext.unregisterTokenRefresh', arguments);
+
+    return bridge.executeNativeMethod('unregisterTokenRefresh', [this.authority, this.validateAuthority, resourceUrl, clientId, userId]);
+};
+
+/**
+ * Gets the background refresh schedule and the outcome of the last refresh for every token
+ * registered with registerTokenRefresh.
+ *
+ * @returns {Promise} Promise either fulfilled with array of schedule entries or rejected with error
+ */
+AuthenticationContext.prototype.getTokenRefreshScheduleAsync = function () {
+
+    checkArgs('', 'AuthenticationContext.getTokenRefreshScheduleAsync', arguments);
+
+    var d = new Deferred();
+
+    bridge.executeNativeMethod('getTokenRefreshSchedule', [this.authority, this.validateAuthority])
+    .then(function (entries) {
+        d.resolve(entries.map(function (entry) {
+            return {
+                resource: entry.resource,
+                clientId: entry.clientId,
+                userId: entry.userId,
+                expiresOn: entry.expiresOn ? new Date(entry.expiresOn) : null,
+                nextRefreshOn: entry.nextRefreshOn ? new Date(entry.nextRefreshOn) : null,
+                lastRefreshOn: entry.lastRefreshOn ? new Date(entry.lastRefreshOn) : null,
+                lastOutcome: entry.lastOutcome,
+                lastError: entry.lastError,
+                successCount: entry.successCount,
+                failureCount: entry.failureCount
+            };
+        }));
+    }, function(err) {
+        d.reject(err);
+    });
+
+    return d;
+};
+
+/**
+ * Gets latency histograms collected by the native layer since the app started. Each entry is
+ * keyed by operation (e.g. 'cacheLookup', 'authorityValidation', 'http', 'storage',
+ * 'acquireTokenSilent') and holds the sample count and p50/p90/p99/max latency in milliseconds.
+ * A 'counters' entry also holds work that was not served from cache: broker signature checks
+ * and broker account queries on Android, Workplace Join keychain identity lookups on iOS. The
+ * set of operations may differ between platforms.
+ *
+ * @returns {Promise} Promise either fulfilled with metrics snapshot object or rejected with error
+ */
+AuthenticationContext.getMetricsSnapshot = function () {
+
+    checkArgs('', 'AuthenticationContext.getMetricsSnapshot', arguments);
+
+    return bridge.executeNativeMethod('getMetricsSnapshot', []);
+};
+
 module.exports = AuthenticationContext;
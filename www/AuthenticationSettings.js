@@ -33,13 +33,23 @@ module.exports = {
         return deferred;
     },
 
+    /**
+     * Sets a function to receive log items from native code.
+     * Native code delivers log items in batches, the function is called once per item in
+     * the order they were logged.
+     *
+     * @param   {Function}  userLogFunc       Function that accepts a LogItem
+     */
     setLogger: function (userLogFunc) {
         exec(
             function(res) {
-                userLogFunc(new LogItem(res));
+                var items = Array.isArray(res) ? res : [res];
+                items.forEach(function (item) {
+                    userLogFunc(new LogItem(item));
+                });
             },
             null,
-            cordova.platformId === 'OIDCProxy',
+            "OIDCProxy",
             "setLogger",
             []);
     },
@@ -1,7 +1,8 @@
 function LogItem(item) {
     this.message = item.message;
     this.level = item.level;
-    this.additionalMessage = item.additionalMessage;
+    // iOS reports additional details as additionalInfo
+    this.additionalMessage = item.additionalMessage || item.additionalInfo;
     this.tag = item.tag;
     this.errorCode = item.errorCode;
 }